@@ -0,0 +1,16 @@
+#ifndef BENCH_HPP
+#define BENCH_HPP
+
+#include <ostream>
+#include "GridEngine.hpp"
+
+// Bancs d'essai fixes (--headless --bench) : soupe dense, canon de Gosper et
+// export d'images. Toujours les mêmes graines et les mêmes tailles, pour
+// comparer des compilations entre elles (make report) et entraîner la
+// compilation guidée par profil (make pgo). Les grilles utilisent le moteur
+// demandé (--engine), ou le choix automatique. Une ligne par banc :
+//
+//   bench soup gen_per_s=... cells_per_s=... ms=...
+void runBenchmarks(std::ostream& out, bool autoEngine = true, EngineKind engine = EngineKind::SPARSE);
+
+#endif
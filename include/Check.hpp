@@ -0,0 +1,41 @@
+#ifndef CHECK_HPP
+#define CHECK_HPP
+
+#include <cstdint>
+#include <ostream>
+#include <vector>
+#include "Grid.hpp"
+
+// Vérification différentielle (--headless --check) : des soupes aléatoires et
+// des motifs connus avancent en parallèle dans Grid, avec chacun des moteurs
+// (GridEngine.hpp), et dans une implémentation de référence volontairement
+// naïve (std::set, voisins comptés cellule par cellule). Population et
+// empreinte sont comparées à chaque génération, getCellsInRect de temps en
+// temps, avec des éditions aléatoires en cours de route (setCell,
+// setGodCell, randomize_selection) et une migration de moteur aller-retour.
+// Une copie (Grid::snapshot) prise au quart du parcours doit être restée
+// intacte à la fin, et la grille restaurée doit repartir comme la référence.
+// Les mêmes cas repassent avec le choix automatique du moteur
+// (EngineSelector.hpp), qui doit changer de moteur au moins une fois. Un
+// champ de plus de 16384 tuiles actives compare enfin TILED à SPARSE, et
+// une grille TILED sous un petit budget mémoire (Grid::setTileBudget) doit
+// suivre la même grille sans budget.
+// Une même graine rejoue exactement les mêmes cas.
+//
+// Motifs de référence, aussi utilisés par les bancs d'essai (Bench.hpp)
+struct KnownPattern {
+    const char* name;
+    RuleSet rule;
+    std::vector<const char*> rows; // 'O' : cellule vivante
+};
+
+const std::vector<KnownPattern>& knownPatterns();
+
+// Ajoute le motif à la grille, coin haut-gauche en (x, y)
+void placePattern(const KnownPattern& pattern, Grid& grid, int64_t x, int64_t y);
+
+// Renvoie le nombre de cas en échec ; le premier écart de chaque cas est
+// décrit sur out.
+int runDifferentialCheck(uint64_t seed, uint64_t generations, std::ostream& out);
+
+#endif
@@ -0,0 +1,75 @@
+#ifndef ENGINESELECTOR_HPP
+#define ENGINESELECTOR_HPP
+
+#include <cstdint>
+#include <vector>
+#include "GridEngine.hpp"
+
+// Choix automatique du moteur (Grid::setAutoEngine) : toutes les K
+// générations, la grille est mesurée et passe au moteur dont le coût prévu
+// est le plus bas. Le coût d'une génération est estimé d'après des temps
+// mesurés (make release) :
+//
+//   SPARSE : ~1,1 µs par cellule vivante (tri des voisins)
+//   TILED  : ~4 µs par tuile occupée quand les tuiles se touchent, jusqu'à
+//            ~10,5 µs quand elles sont isolées (voisines vides calculées aussi)
+//
+// SET n'est jamais choisi : c'est le moteur de référence.
+static const uint64_t ENGINE_SAMPLE_INTERVAL = 64; // K, en générations
+// Première mesure après un chargement ou un effacement, sans attendre K
+static const size_t ENGINE_FIRST_SAMPLE = 4;
+static const double ENGINE_SPARSE_CELL_US = 1.1;
+static const double ENGINE_TILED_TILE_US = 4.0;
+static const double ENGINE_TILED_ISOLATED_TILE_US = 10.5;
+// Le moteur prévu doit être au moins ENGINE_SWITCH_MARGIN fois plus rapide
+// que le moteur courant, sinon on ne change pas (la migration a un coût)
+static const double ENGINE_SWITCH_MARGIN = 1.5;
+// Plus longue période cherchée dans l'historique des générations
+static const int ENGINE_MAX_PERIOD = 30;
+
+struct PatternStats {
+    uint64_t generation = 0; // Générations calculées avec le choix automatique
+    size_t population = 0;
+    size_t tiles = 0;
+    double density = 0.0;  // Cellules vivantes / surface des tuiles occupées
+    double fill = 0.0;     // Tuiles occupées / tuiles de la boîte englobante
+    double activity = 0.0; // (naissances + morts) / population, par génération
+    int period = 0;        // Période probable (population et naissances qui se répètent), 0 si aucune
+};
+
+class EngineSelector {
+public:
+    explicit EngineSelector(uint64_t interval = ENGINE_SAMPLE_INTERVAL);
+
+    // Appelé après chaque génération ; vrai quand il est temps de mesurer
+    // (choose) : toutes les interval générations, et ENGINE_FIRST_SAMPLE
+    // générations après reset()
+    bool observe(size_t population, uint64_t births, uint64_t deaths);
+
+    // Oublie l'historique (grille remplacée ou effacée)
+    void reset();
+
+    // Mesure le moteur et renvoie le moteur conseillé (le moteur courant
+    // si aucun autre n'est assez intéressant)
+    EngineKind choose(const GridEngine& engine, PatternStats& stats) const;
+
+    // Coût prévu d'une génération, en microsecondes (0 pour SET, non estimé)
+    static double predictCost(EngineKind kind, const PatternStats& stats);
+
+private:
+    struct Sample {
+        size_t population;
+        uint64_t births;
+        uint64_t deaths;
+    };
+
+    uint64_t interval;
+    uint64_t generation = 0;
+    std::vector<Sample> history; // Les 2 * ENGINE_MAX_PERIOD dernières générations, tourniquet
+    size_t head = 0;             // Prochaine case écrite
+
+    const Sample& recent(size_t age) const; // 0 : la dernière génération
+    int findPeriod() const;
+};
+
+#endif
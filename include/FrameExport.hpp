@@ -0,0 +1,95 @@
+#ifndef FRAMEEXPORT_HPP
+#define FRAMEEXPORT_HPP
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Grid.hpp"
+
+// Export d'images sans SDL : la grille est dessinée dans un tampon de pixels
+// (un index de palette par pixel) puis encodée sur des threads de travail.
+// Chaque image est compressée indépendamment ; seule l'écriture dans le
+// fichier se fait dans l'ordre.
+
+// Fond, cellule vivante, cellule Dieu (mêmes couleurs que la fenêtre)
+static const uint8_t FRAME_PALETTE[3][3] = {
+    { 20, 20, 30 },
+    { 100, 255, 100 },
+    { 255, 215, 0 }
+};
+
+// Zone de la grille à dessiner
+struct FrameView {
+    int64_t x = 0, y = 0;          // Coin haut-gauche, en cellules
+    int64_t width = 0, height = 0; // Taille, en cellules
+    double zoom = 1.0;             // Pixels par cellule (< 1 : plusieurs cellules par pixel)
+
+    int pixelWidth() const;
+    int pixelHeight() const;
+};
+
+// Remplit pixels (pixelWidth * pixelHeight octets) ; cells sert de tampon
+// réutilisé d'une image à l'autre
+void rasterizeFrame(const Grid& grid, const FrameView& view, std::vector<uint8_t>& pixels,
+                    std::vector<Cell>& cells);
+
+class FrameExporter {
+public:
+    enum class Format {
+        PNG_SEQUENCE, // nom_000000.png, nom_000001.png...
+        GIF,
+        APNG
+    };
+
+    // Format d'après l'extension : .gif, .apng, sinon une suite de PNG.
+    // thread_count = 0 : un thread par coeur
+    FrameExporter(const std::string& path, int width, int height, int delay_ms, unsigned thread_count = 0);
+    ~FrameExporter();
+
+    bool good() const;
+
+    // Confie une image aux threads d'encodage ; bloque tant que trop d'images
+    // attendent d'être écrites, pour borner la mémoire
+    void addFrame(std::vector<uint8_t> pixels);
+
+    // Attend les dernières images et termine le fichier
+    bool finish();
+
+private:
+    struct Frame {
+        uint64_t index;
+        std::vector<uint8_t> pixels;
+    };
+
+    std::string path;
+    Format format;
+    int width, height, delay_ms;
+    std::ofstream out; // GIF et APNG
+    uint64_t actl_offset = 0; // Nombre d'images de l'APNG, connu à la fin
+    uint32_t sequence = 0;    // Numéros de séquence des chunks APNG
+
+    std::vector<std::thread> workers;
+    mutable std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable space;
+    std::deque<Frame> pending;
+    std::map<uint64_t, std::vector<uint8_t>> encoded; // En attente des images précédentes
+    uint64_t submitted = 0;
+    uint64_t written = 0;
+    size_t max_queued;
+    bool stopping = false;
+    bool failed = false;
+    bool finished = false;
+
+    void run();
+    std::vector<uint8_t> encode(const Frame& frame) const;
+    bool writeFrame(uint64_t index, const std::vector<uint8_t>& data);
+};
+
+#endif
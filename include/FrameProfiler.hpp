@@ -0,0 +1,70 @@
+#ifndef FRAMEPROFILER_HPP
+#define FRAMEPROFILER_HPP
+
+#include <cstdint>
+
+// Temps passé dans chaque phase d'une image, gardé sur les FRAME_HISTORY
+// dernières images pour l'affichage (Game::renderUI, touche F3)
+class ProfileScope;
+
+enum class FramePhase {
+    EVENTS,
+    STEP,
+    HISTORY,
+    RENDER_GRID,
+    RENDER_UI,
+    PRESENT,
+    COUNT
+};
+
+class FrameProfiler {
+public:
+    static const int FRAME_HISTORY = 120;
+    static const int PHASE_COUNT = static_cast<int>(FramePhase::COUNT);
+
+    FrameProfiler();
+
+    // Clôt l'image en cours et en commence une nouvelle
+    void beginFrame();
+
+    void addTime(FramePhase phase, double ms);
+    // Générations calculées pendant l'image, et cellules traitées pour cela
+    void addWork(uint64_t generations, uint64_t cells);
+
+    // age 0 : image en cours, 1 : la précédente...
+    double phaseTime(FramePhase phase, int age) const;
+    double averageTime(FramePhase phase) const;
+    double averageFrameTime() const;
+    double generationsPerSecond() const;
+    double cellsPerSecond() const;
+
+    static const char* phaseName(FramePhase phase);
+
+private:
+    double times[FRAME_HISTORY][PHASE_COUNT];
+    double frameTimes[FRAME_HISTORY]; // Durée totale de chaque image, ms
+    uint64_t generations[FRAME_HISTORY];
+    uint64_t cells[FRAME_HISTORY];
+    int current;
+    uint64_t frameStart;
+    ProfileScope* active = nullptr; // Portée la plus intérieure en cours
+
+    friend class ProfileScope;
+};
+
+// Ajoute la durée de sa portée à une phase. Une portée ouverte dans une autre
+// (addToHistory pendant les événements...) suspend celle-ci : chaque instant
+// n'est compté que dans une phase.
+class ProfileScope {
+public:
+    ProfileScope(FrameProfiler& profiler, FramePhase phase);
+    ~ProfileScope();
+
+private:
+    FrameProfiler& profiler;
+    FramePhase phase;
+    uint64_t start;
+    ProfileScope* outer;
+};
+
+#endif
@@ -3,16 +3,42 @@
 
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_ttf.h>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
 #include <vector>
+#include "FrameProfiler.hpp"
 #include "Grid.hpp"
+#include "InputLog.hpp"
+#include "Journal.hpp"
+#include "Metrics.hpp"
+#include "PatternLibrary.hpp"
+#include "Recording.hpp"
+#include "SaveFile.hpp"
 
 class Game {
 private:
     enum GameState {
         MAIN_MENU,
-        IN_GAME
+        IN_GAME,
+        SAVE_BROWSER
     };
 
+    // Entrée du navigateur de sauvegardes : les métadonnées et l'aperçu ne sont
+    // lus que lorsque la ligne devient visible
+    struct SaveSlot {
+        std::string path;
+        bool infoLoaded = false;
+        bool valid = false;
+        SaveInfo info = {};
+        uint64_t frames = 0; // Enregistrements .rec
+        SDL_Texture* thumbnail = nullptr;
+    };
+
+    static const int SAVE_ROW_HEIGHT = 80;
+    static constexpr double TRACE_DUMP_SECONDS = 10.0;
+
     static const int CELL_SIZE = 20;
     const int UI_WIDTH = 250; // Largeur du panneau d'interface
     int WIDTH;
@@ -34,11 +60,72 @@ private:
     bool running;
     bool paused;
     Uint32 simulation_speed_ms; // Vitesse de simulation en ms
-    int generation_count;
+    uint64_t steps_per_update; // Générations calculées par mise à jour (Next Step xN)
+    uint64_t generation_count;
     Uint32 last_update_time;
+    uint64_t random_seed; // Graine du prochain remplissage aléatoire
+
+    // Sauvegarde en arrière-plan
+    std::thread saveThread;
+    std::atomic<bool> saving{false};
+    std::atomic<float> saveProgress{0.0f};
+
+    // Journal de sauvegarde automatique (autosave.journal)
+    std::unique_ptr<JournalWriter> journal;
+    bool journalDirty; // Cellules, cellules Dieu ou règle changées depuis le dernier état confié au journal
+    bool hasAutosave;  // Un journal existe, le menu propose de le reprendre
+
+    // Enregistrement de chaque génération (saves/run_*.rec) et relecture d'un
+    // enregistrement sans resimuler
+    std::unique_ptr<RecordingWriter> recorder;
+    std::unique_ptr<RecordingReader> playback;
+
+    // Bibliothèque de motifs (dossier patterns/) : L active le tampon, [ et ]
+    // choisissent le motif, un clic sur la grille le pose
+    PatternLibrary patternLibrary{"patterns"};
+    bool libraryScanned = false;
+    bool stampMode = false;
+    size_t stampIndex = 0;
+    std::vector<Cell> stampCells;
+
+    // Navigateur de sauvegardes (dossier saves/)
+    std::vector<SaveSlot> saveSlots;
+    int saveScroll; // Première ligne affichée
+    SDL_Rect browserBackButton;
+
+    // Temps par phase des dernières images, affichés avec F3
+    FrameProfiler profiler;
+    bool showProfiler = false;
+
+    // Métriques Prometheus (--metrics), absentes par défaut
+    std::unique_ptr<MetricsFile> metrics;
+
+    // Enregistrement des entrées (--record-input) ou relecture sans attente
+    // (--replay-input) : pendant une relecture, l'horloge, les touches de
+    // modification et la souris viennent du journal et non de SDL
+    std::unique_ptr<InputRecorder> inputRecorder;
+    std::unique_ptr<InputReplay> inputReplay;
+    std::vector<InputEvent> frameInput; // Événements de l'image en cours
+    size_t replayCursor = 0;
+    Uint32 frameTicks = 0;              // SDL_GetTicks() au début de l'image
+    Uint32 inputMods = 0;
+    int inputMouseX = 0, inputMouseY = 0;
+    std::vector<double> replayFrameTimes; // ms, pour le rapport de fin
+    std::string replayJournal;            // Journal de reprise temporaire de la relecture
+
+    // Les fichiers absents du journal des entrées (sauvegardes, journal de
+    // reprise, pattern.rle, bibliothèque de motifs) ne sont pas lus pendant
+    // un enregistrement ou une relecture : la relecture refait exactement la
+    // même partie. Pendant une relecture, rien n'est écrit à côté des fichiers
+    // de l'utilisateur. Vrai, avec un message, si l'action est refusée.
+    bool refuseFileRead(const char* action) const;
+    bool refuseFileWrite(const char* action) const;
+
+    // Cellules visibles, réutilisé à chaque image par renderGrid()
+    std::vector<Cell> visibleCells;
 
     // Historique
-    std::vector<std::set<Cell>> history;
+    std::vector<std::shared_ptr<const GridEngine>> history; // Grid::shareCells (tuiles partagées avec TILED seulement)
     int history_index;
 
     // In-Game UI Buttons
@@ -50,14 +137,19 @@ private:
     SDL_Rect randomizeButton;
     SDL_Rect godModeButton;
     SDL_Rect saveButton;
+    SDL_Rect exportRleButton; // Exporte la grille vers pattern.rle
     SDL_Rect backToMenuButton;
     SDL_Rect speedUpButton;
     SDL_Rect slowDownButton;
     SDL_Rect changeRulesButton;
+    SDL_Rect engineButton; // Auto, puis chaque moteur imposé tour à tour (GridEngine.hpp)
+    SDL_Rect recordButton; // Record / Stop Rec, ou Stop Playback pendant une relecture
 
     // Main Menu UI Buttons
     SDL_Rect newGameButton;
     SDL_Rect loadGameButton;
+    SDL_Rect importRleButton; // Charge pattern.rle
+    SDL_Rect resumeButton;    // Reprend l'état du journal de sauvegarde automatique
     SDL_Rect quitButton;
 
     bool godModeActive; // Pour savoir si on place des cellules en mode Dieu
@@ -87,8 +179,38 @@ private:
     void renderUI();
     void renderGrid();
     void renderMainMenu();
+    void renderProfiler();
+    // Événement suivant, de SDL ou du journal relu
+    bool nextEvent(SDL_Event& event);
+    void reportReplay() const;
+    void dumpTrace(); // F9 : les TRACE_DUMP_SECONDS dernières secondes, en JSON Chrome trace
     void renderText(const char* text, int x, int y, int w, int h, SDL_Color color);
 
+    // Copie la grille et l'écrit sur un thread d'E/S, sans bloquer la simulation
+    void startSave(const std::string& filename);
+
+    // Nouveau fichier saves/slot_AAAAMMJJ_HHMMSS.dat
+    std::string newSaveSlotPath(const std::string& prefix = "slot_", const std::string& extension = ".dat");
+    void openSaveBrowser();
+    void closeSaveBrowser();
+    void handleBrowserEvents(SDL_Event& event);
+    void renderSaveBrowser();
+
+    // Calcule n générations ; pendant un enregistrement, chacune devient une frame
+    void stepSimulation(uint64_t n);
+    void toggleRecording();
+    // Avance de frames frames dans l'enregistrement relu
+    void advancePlayback(uint64_t frames);
+    // Quitte la relecture : la partie continue depuis la frame affichée
+    void stopPlayback();
+
+    void toggleStampMode();
+    // Motif lisible suivant (direction 1) ou précédent (-1)
+    void selectPattern(int direction);
+
+    // Réinitialise l'historique et le journal après un chargement ou une nouvelle partie
+    void startSession();
+
     void addToHistory();
     void undo();
     void redo();
@@ -98,6 +220,14 @@ public:
     ~Game();
     
     void run();
+
+    // Écrit les métriques dans path toutes les interval_seconds secondes
+    void enableMetrics(const std::string& path, double interval_seconds);
+
+    // À appeler avant run() ; renvoient false si le fichier est inutilisable.
+    // La relecture se termine à la fin du journal et affiche les temps d'image.
+    bool recordInput(const std::string& path);
+    bool replayInput(const std::string& path);
 };
 
 #endif
\ No newline at end of file
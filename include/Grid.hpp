@@ -1,16 +1,28 @@
 #ifndef GRID_HPP
 #define GRID_HPP
 
-#include <set>
+#include <atomic>
+#include <cstdint>
+#include <memory>
 #include <string>
 #include <vector>
 
 struct Cell {
-    int x, y;
-    
+    int64_t x, y;
+
+    // Coordonnée signée -> non signée, en conservant l'ordre
+    static uint64_t key(int64_t v) {
+        return static_cast<uint64_t>(v) ^ (1ULL << 63);
+    }
+
+    // Ordre de Morton (bits de y et x entrelacés, y en poids fort) sans
+    // calculer le code : on compare l'axe dont le bit différent est le plus haut.
     bool operator<(const Cell& other) const {
-        if (x != other.x) return x < other.x;
-        return y < other.y;
+        uint64_t ax = key(x), bx = key(other.x);
+        uint64_t ay = key(y), by = key(other.y);
+        uint64_t dx = ax ^ bx, dy = ay ^ by;
+        if (dy < dx && dy < (dx ^ dy)) return ax < bx;
+        return ay < by;
     }
 
     bool operator==(const Cell& other) const {
@@ -24,42 +36,161 @@ enum class RuleSet {
     COUNT       // Helper to count number of rulesets
 };
 
+class GridEngine;
+class EngineSelector;
+class TileStore;
+struct Tile;
+enum class EngineKind;
+
+// Copie figée de la grille : la Grid d'origine peut continuer d'avancer, et la
+// copie être écrite sur disque depuis un autre thread. Les cellules vivantes
+// sont soit une liste triée (aliveCells), soit une copie du moteur (frozen,
+// voir Grid::snapshot) qui n'est développée qu'à la lecture.
+struct GridSnapshot {
+    std::vector<Cell> aliveCells;
+    std::shared_ptr<const GridEngine> frozen;
+    std::vector<Cell> godCells;
+    RuleSet rules = RuleSet::CONWAY;
+    uint64_t generation = 0; // Enregistrée dans les sauvegardes binaires
+
+    // Cellules vivantes triées ; scratch reçoit le développement de frozen
+    const std::vector<Cell>& cells(std::vector<Cell>& scratch) const;
+    // Cellules vivantes en tuiles (Tile.hpp), sans développer frozen
+    void tiles(std::vector<Tile>& out) const;
+
+    // Même format que Grid::saveToFile ; progress avance de 0 à 1
+    bool saveToFile(const std::string& filename, std::atomic<float>* progress = nullptr) const;
+};
+
 class Grid {
 private:
-    std::set<Cell> aliveCells;
-    std::set<Cell> godCells; // Cellules en mode Dieu
-    RuleSet currentRuleSet;
-    
+    // Cellules vivantes (GridEngine.hpp) et cellules en mode Dieu, triées et
+    // sans doublons
+    std::unique_ptr<GridEngine> engine;
+    // Choix automatique du moteur (EngineSelector.hpp) ; nullptr quand le
+    // moteur a été imposé par setEngine
+    std::unique_ptr<EngineSelector> selector;
+    // Budget mémoire des tuiles (setTileBudget), redonné à chaque nouveau moteur
+    size_t tileBudget = 0;
+    std::shared_ptr<TileStore> tileStore;
+    std::vector<Cell> godCells;
+    RuleSet currentRuleSet = RuleSet::CONWAY;
+
+    // Liste triée des cellules vivantes pour les moteurs qui n'en tiennent
+    // pas (getAliveCells), refaite après chaque modification
+    mutable std::vector<Cell> cellCache;
+    mutable bool cacheValid = false;
+
+    // Naissances et morts depuis la création de la grille (advance uniquement)
+    uint64_t births = 0;
+    uint64_t deaths = 0;
+
+    // Calcule une génération ; renvoie false si la grille n'a pas changé
+    bool advance();
+
+    // Remplace le moteur en gardant les cellules vivantes
+    void migrate(EngineKind kind);
+    // Mesure la grille et change de moteur si le sélecteur le conseille
+    void selectEngine();
+
+    // Fusionne un lot de cellules (non trié) dans les cellules vivantes
+    void mergeCells(std::vector<Cell>& cells);
+
+    // Remplit un rectangle au hasard (xoshiro256**, une graine par colonne,
+    // colonnes réparties sur plusieurs threads) et fusionne le résultat
+    void fillRandom(int64_t start_x, int64_t start_y, int width, int height, uint64_t seed, double density);
+
 public:
+    Grid();
+    ~Grid();
+
+    // Change de moteur en gardant l'état courant ; désactive le choix automatique
+    void setEngine(EngineKind kind);
+    EngineKind getEngine() const;
+
+    // Choix automatique du moteur, actif par défaut : toutes les
+    // ENGINE_SAMPLE_INTERVAL générations, la grille passe au moteur prévu le
+    // plus rapide. Chaque changement est écrit sur la sortie standard.
+    void setAutoEngine(bool enabled);
+    bool isAutoEngine() const;
+
+    // Au-delà de bytes octets de tuiles en mémoire, le moteur TILED range ses
+    // tuiles endormies dans un fichier d'échange créé dans directory
+    // (TileStore.hpp). 0 : pas de limite. Renvoie false si le fichier ne
+    // peut pas être créé.
+    bool setTileBudget(size_t bytes, const std::string& directory);
+    // Tuiles actuellement rangées dans le fichier d'échange
+    size_t evictedTiles() const;
+
     // Définir l'état d'une cellule
-    void setCell(int x, int y, bool alive);
+    void setCell(int64_t x, int64_t y, bool alive);
     
     // Vérifier si une cellule est vivante
-    bool isAlive(int x, int y) const;
+    bool isAlive(int64_t x, int64_t y) const;
     
     // Compter les voisins vivants d'une cellule
-    int countNeighbors(int x, int y) const;
+    int countNeighbors(int64_t x, int64_t y) const;
     
     // Mettre à jour la grille selon les règles du Jeu de la Vie
     void update(bool& simPaused);
+
+    // Avance de n générations d'un coup, sans passer par l'interface ni
+    // l'historique. S'arrête dès que la grille ne change plus.
+    void step(uint64_t n);
     
-    // Obtenir l'ensemble des cellules vivantes
-    const std::set<Cell>& getAliveCells() const;
+    // Obtenir l'ensemble des cellules vivantes, triées (ordre de Morton).
+    // Avec un autre moteur que SPARSE, la liste est refaite après chaque
+    // modification : préférer population(), bounds() ou getCellsInRect()
+    const std::vector<Cell>& getAliveCells() const;
+    size_t population() const;
+    // Boîte englobante des cellules vivantes ; false si la grille est vide
+    bool bounds(int64_t& min_x, int64_t& min_y, int64_t& max_x, int64_t& max_y) const;
+
+    // Octets réservés par le moteur, les cellules Dieu et la liste triée
+    size_t memoryUsage() const;
+
+    // Nombre de tuiles 64x64 occupées par des cellules vivantes
+    size_t tileCount() const;
+
+    // Totaux cumulés sur toutes les générations calculées ; les éditions
+    // (setCell, randomize, chargement...) ne comptent pas
+    uint64_t totalBirths() const;
+    uint64_t totalDeaths() const;
+
+    // Ajoute à out les cellules vivantes du rectangle [x0, x1] x [y0, y1].
+    // Grâce à l'ordre de Morton, seuls les morceaux du tableau qui recouvrent
+    // le rectangle sont parcourus.
+    void getCellsInRect(int64_t x0, int64_t y0, int64_t x1, int64_t y1, std::vector<Cell>& out) const;
 
     // Nouvelles fonctions
     void clear();
-    void randomize(int width, int height, int x_offset, int y_offset);
-    void randomize_selection(int start_x, int start_y, int width, int height);
-    void setGodCell(int x, int y, bool isGod);
-    bool isGod(int x, int y) const;
-    const std::set<Cell>& getGodCells() const;
-    void setAliveCells(const std::set<Cell>& cells);
+    // density : probabilité qu'une cellule soit vivante (précision 1/256).
+    // Une même graine donne toujours le même résultat.
+    void randomize(int width, int height, int64_t x_offset, int64_t y_offset, uint64_t seed, double density = 0.2);
+    void randomize_selection(int64_t start_x, int64_t start_y, int width, int height, uint64_t seed, double density = 0.5);
+    void setGodCell(int64_t x, int64_t y, bool isGod);
+    bool isGod(int64_t x, int64_t y) const;
+    const std::vector<Cell>& getGodCells() const;
+    void setAliveCells(const std::vector<Cell>& cells);
+    // Copie figée des cellules vivantes (GridEngine::clone), dont le contenu
+    // ne bouge plus. Seul TILED la fait en quelques microsecondes (tuiles
+    // partagées) ; SPARSE et SET copient toutes les cellules, comme avant.
+    // setAliveCells la reprend de la même façon quand le moteur est du même type.
+    std::shared_ptr<const GridEngine> shareCells() const;
+    void setAliveCells(const GridEngine& cells);
+    // Ajoute un lot de cellules vivantes (motif de la bibliothèque) en une seule fusion
+    void stampCells(std::vector<Cell> cells);
     void setRuleSet(RuleSet rules);
     RuleSet getRuleSet() const;
 
-    // Save/Load
-    bool saveToFile(const std::string& filename);
-    bool loadFromFile(const std::string& filename);
+    // Save/Load : format selon l'extension (.rle, .mc, sinon sauvegarde binaire,
+    // compressée sauf si compress est faux)
+    bool saveToFile(const std::string& filename, uint64_t generation = 0, bool compress = true);
+    // Les cellules vivantes sont partagées avec le moteur (shareCells) ;
+    // copiées avec SPARSE et SET
+    GridSnapshot snapshot() const;
+    void restore(GridSnapshot snapshot);
+    bool loadFromFile(const std::string& filename, uint64_t* generation = nullptr);
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,100 @@
+#ifndef GRIDENGINE_HPP
+#define GRIDENGINE_HPP
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "Grid.hpp"
+
+class TileStore;
+struct Tile;
+
+// Stockage et calcul des cellules vivantes derrière Grid. Grid garde les
+// cellules Dieu, la règle et les compteurs ; le moteur ne voit que les
+// cellules vivantes et peut être changé en cours de partie
+// (Grid::setEngine), l'état passant de l'un à l'autre par save()/load().
+//
+//   SPARSE : tableau trié dans l'ordre de Morton, voisins comptés par tri
+//            (motifs clairsemés, peu de cellules sur une grande surface)
+//   TILED  : tuiles 64x64 d'une rangée de 64 bits par ligne, calculées
+//            64 cellules à la fois (soupes denses)
+//   SET    : std::set, le plus simple et le plus lent (référence)
+enum class EngineKind {
+    SPARSE,
+    TILED,
+    SET,
+    COUNT
+};
+
+class GridEngine {
+public:
+    virtual ~GridEngine() = default;
+
+    virtual EngineKind kind() const = 0;
+
+    // Copie indépendante, par exemple pour l'historique ou une sauvegarde
+    // en tâche de fond. TILED ne copie que des pointeurs (tuiles partagées,
+    // copiées à l'écriture) ; les autres moteurs copient toutes les cellules.
+    // La copie peut être lue depuis un autre thread pendant que l'original
+    // continue d'avancer.
+    virtual std::unique_ptr<GridEngine> clone() const = 0;
+
+    virtual void setCell(int64_t x, int64_t y, bool alive) = 0;
+    virtual bool isAlive(int64_t x, int64_t y) const = 0;
+    virtual void clear() = 0;
+
+    // Ajoute un lot de cellules vivantes (dans n'importe quel ordre, doublons
+    // compris) ; le lot peut être modifié
+    virtual void addCells(std::vector<Cell>& cells) = 0;
+
+    // Sérialisation : toutes les cellules vivantes, triées dans l'ordre de
+    // Morton et sans doublons, dans un sens comme dans l'autre
+    virtual void load(std::vector<Cell> cells) = 0;
+    virtual void save(std::vector<Cell>& out) const = 0;
+
+    // La même liste si le moteur la tient déjà à jour, sans copie (sinon nullptr)
+    virtual const std::vector<Cell>* sortedCells() const { return nullptr; }
+
+    // Les cellules vivantes en tuiles (Tile.hpp), dans l'ordre de Morton,
+    // pour les sauvegardes, le journal et les enregistrements. TILED copie
+    // ses tuiles sans passer par la liste des cellules.
+    virtual void saveTiles(std::vector<Tile>& out) const;
+    // Remplace toutes les cellules par ces tuiles (non vides, dans l'ordre de
+    // Morton). TILED les garde telles quelles, les autres passent par load().
+    virtual void loadTiles(std::vector<Tile> tiles);
+
+    // Calcule une génération. Les cellules de god (triées) gardent leur
+    // état ; births reçoit le nombre de naissances. Renvoie false si rien
+    // n'a changé.
+    virtual bool step(RuleSet rule, const std::vector<Cell>& god, uint64_t& births) = 0;
+
+    // Ajoute à out les cellules vivantes du rectangle [x0, x1] x [y0, y1],
+    // dans l'ordre de Morton
+    virtual void getCellsInRect(int64_t x0, int64_t y0, int64_t x1, int64_t y1, std::vector<Cell>& out) const = 0;
+
+    virtual size_t population() const = 0;
+    // Boîte englobante des cellules vivantes ; false si le moteur est vide
+    virtual bool bounds(int64_t& min_x, int64_t& min_y, int64_t& max_x, int64_t& max_y) const = 0;
+    // Tuiles 64x64 occupées
+    virtual size_t tileCount() const = 0;
+    // Octets réservés ; une tuile partagée est répartie entre les copies qui
+    // la tiennent, si bien que les totaux s'additionnent sans compter double
+    virtual size_t memoryUsage() const = 0;
+
+    // Mémoire limitée (TileStore.hpp) : au-delà de bytes octets de tuiles en
+    // mémoire, les tuiles endormies partent dans store ; bytes = 0 lève la
+    // limite. Sans effet sur les moteurs qui ne savent pas le faire (seul
+    // TILED le fait).
+    virtual void setBudget(size_t, std::shared_ptr<TileStore>) {}
+    // Tuiles rangées dans le fichier d'échange
+    virtual size_t evictedTiles() const { return 0; }
+};
+
+std::unique_ptr<GridEngine> makeEngine(EngineKind kind);
+
+const char* engineName(EngineKind kind);
+// "sparse", "tiled" ou "set" ; false si le nom est inconnu
+bool parseEngine(const std::string& name, EngineKind& kind);
+
+#endif
@@ -0,0 +1,57 @@
+#ifndef HEADLESS_HPP
+#define HEADLESS_HPP
+
+#include <iosfwd>
+
+// Mode sans fenêtre : charge ou génère une grille, avance de N générations
+// avec Grid::step() et sauvegarde le résultat. Les fichiers .rle et .mc sont
+// lus et écrits aux formats RLE et macrocell, les autres au format binaire
+// (compressé sauf avec --uncompressed).
+//
+//   shinra_tensei --headless [--load FILE] [--random WxH] [--seed S]
+//                 [--density D] [--rules conway|highlife] [--steps N]
+//                 [--save FILE] [--uncompressed] [--record FILE.rec]
+//                 [--export FILE.gif|FILE.apng|FILE.png] [--view X,Y,WxH]
+//                 [--zoom Z] [--every N] [--delay MS] [--threads N]
+//                 [--trace FILE.json] [--metrics FILE.prom]
+//                 [--metrics-interval S] [--engine auto|sparse|tiled|set]
+//                 [--memory-budget MB] [--swap-dir DIR]
+//   shinra_tensei --headless --check [--seed S] [--steps N]
+//   shinra_tensei --headless --bench [--engine auto|sparse|tiled|set]
+//
+// --export dessine la vue (par défaut la boîte englobante de départ, Z pixels
+// par cellule) toutes les N générations : GIF ou APNG animé, ou une suite
+// FILE_000000.png... L'encodage se fait sur --threads threads.
+//
+// --check compare Grid à une implémentation de référence sur N générations
+// (64 par défaut, quelques secondes pour make check ; --steps 1024 pour une
+// passe longue), avec chacun des moteurs, et sort avec le code 1 au moindre
+// écart (Check.hpp).
+//
+// --engine impose un moteur de simulation (GridEngine.hpp) ; par défaut
+// (auto), le moteur suit le motif (EngineSelector.hpp).
+//
+// --memory-budget limite les tuiles en mémoire du moteur TILED à MB Mio :
+// au-delà, les tuiles endormies partent dans un fichier d'échange créé (et
+// aussitôt supprimé) dans --swap-dir, le répertoire courant par défaut
+// (TileStore.hpp).
+//
+// --bench lance les bancs d'essai fixes (Bench.hpp), utilisés par make pgo
+// et make report.
+//
+// --metrics réécrit toutes les S secondes (10 par défaut) et à la fin un
+// fichier de métriques au format texte Prometheus (Metrics.hpp).
+//
+// --trace écrit à la fin les zones mesurées (Trace.hpp) au format Chrome
+// trace, à ouvrir dans Perfetto ; seuls les derniers événements de chaque
+// thread sont gardés.
+
+// Options reconnues, en cas d'erreur sur la ligne de commande
+void printUsage(std::ostream& out);
+
+// Vrai si la ligne de commande demande le mode sans fenêtre
+bool isHeadless(int argc, char** argv);
+
+int runHeadless(int argc, char** argv);
+
+#endif
@@ -0,0 +1,76 @@
+#ifndef INPUTLOG_HPP
+#define INPUTLOG_HPP
+
+#include <SDL2/SDL.h>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Journal des entrées d'une partie, pour la rejouer à l'identique (banc
+// d'essai de bout en bout : entrées, simulation et rendu).
+//
+//   InputLogHeader
+//   pour chaque image : InputFrameHeader puis event_count InputEvent
+//
+// Chaque événement garde l'état des touches de modification et la position de
+// la souris au moment où il a été traité, que le jeu lit à la place de SDL
+// pendant la relecture. Les SDL_Event sont écrits tels quels : un journal ne
+// se relit qu'avec la même version de SDL sur la même architecture.
+
+static const char INPUT_LOG_MAGIC[8] = { 'S', 'H', 'I', 'N', 'P', 'U', 'T', 'S' };
+static const uint32_t INPUT_LOG_VERSION = 1;
+
+struct InputLogHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t has_autosave;  // Le menu proposait de reprendre la partie
+    uint64_t random_seed;   // Graine de départ de Game::random_seed
+    uint32_t event_size;    // sizeof(SDL_Event) à l'enregistrement
+    uint32_t reserved;
+};
+
+struct InputFrameHeader {
+    uint32_t ticks;       // SDL_GetTicks() au début de l'image
+    uint32_t event_count;
+};
+
+struct InputEvent {
+    SDL_Event event;
+    uint32_t mods;        // SDL_GetModState()
+    int32_t mouse_x, mouse_y;
+};
+
+// Événements gardés dans le journal : ceux que le jeu traite, qui ne
+// contiennent pas de pointeurs
+bool isRecordedEvent(const SDL_Event& event);
+
+class InputRecorder {
+public:
+    InputRecorder(const std::string& path, uint64_t random_seed, bool has_autosave);
+
+    bool good() const;
+    bool writeFrame(uint32_t ticks, const std::vector<InputEvent>& events);
+
+private:
+    std::ofstream out;
+};
+
+class InputReplay {
+public:
+    explicit InputReplay(const std::string& path);
+
+    bool good() const;
+    uint64_t randomSeed() const;
+    bool hasAutosave() const;
+
+    // Image suivante ; false à la fin du journal (ou s'il est tronqué)
+    bool nextFrame(uint32_t& ticks, std::vector<InputEvent>& events);
+
+private:
+    std::ifstream in;
+    InputLogHeader header = {};
+    bool valid = false;
+};
+
+#endif
@@ -0,0 +1,112 @@
+#ifndef JOURNAL_HPP
+#define JOURNAL_HPP
+
+#include <condition_variable>
+#include <cstdint>
+#include <iosfwd>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Grid.hpp"
+#include "Tile.hpp"
+
+// Journal de sauvegarde automatique : une suite d'enregistrements ajoutés en
+// fin de fichier, chacun avec son en-tête et une somme de contrôle.
+//
+//   keyframe : toutes les tuiles non vides de la grille
+//   delta    : seulement les tuiles modifiées depuis l'enregistrement précédent
+//              (une tuile devenue vide est écrite avec des rangées à zéro),
+//              aucune si seule la règle a changé
+//
+// Les tuiles d'un enregistrement sont compressées en un bloc (voir Lz.hpp).
+// Chaque keyframe démarre un nouveau fichier (écrit à part puis renommé), les
+// deltas suivants y sont ajoutés. Après un arrêt brutal, la relecture s'arrête
+// au dernier enregistrement complet.
+
+static const uint32_t JOURNAL_MAGIC = 0x324A4853; // "SHJ2"
+
+enum class JournalRecord : uint32_t {
+    KEYFRAME = 1,
+    DELTA = 2
+};
+
+struct JournalRecordHeader {
+    uint32_t magic;
+    uint32_t type;
+    uint64_t generation;
+    uint32_t rule;
+    uint32_t tile_count;
+    uint64_t payload_size; // Taille des tuiles compressées qui suivent
+    uint64_t checksum;     // FNV-1a des tuiles compressées
+};
+
+struct JournalTile {
+    int64_t tx, ty;
+    uint64_t layer; // 0 : cellules vivantes, 1 : cellules Dieu
+    uint64_t rows[TILE_SIZE];
+};
+
+// Format d'un enregistrement isolé, partagé avec les enregistrements de
+// simulation (Recording.hpp). Renvoie la taille écrite, 0 en cas d'échec.
+uint64_t writeJournalRecord(std::ostream& out, JournalRecord type, uint64_t generation,
+                            RuleSet rule, const std::vector<JournalTile>& entries);
+
+// Faux si l'enregistrement est tronqué ou corrompu
+bool readJournalRecord(std::istream& in, JournalRecordHeader& header, std::vector<JournalTile>& entries);
+
+// Tuiles de next qui diffèrent de previous, plus les tuiles disparues (vides)
+void diffTiles(const std::vector<Tile>& previous, const std::vector<Tile>& next,
+               uint64_t layer, std::vector<JournalTile>& out);
+
+// Applique des tuiles journalisées (triées) sur un ensemble de tuiles trié
+void applyTiles(std::vector<Tile>& tiles, const std::vector<JournalTile>& entries, uint64_t layer);
+
+void tilesToCells(const std::vector<Tile>& tiles, std::vector<Cell>& cells);
+
+class JournalWriter {
+public:
+    // Un keyframe tous les keyframe_interval enregistrements, débit disque
+    // limité à bytes_per_second
+    JournalWriter(const std::string& path, uint64_t keyframe_interval, uint64_t bytes_per_second);
+    ~JournalWriter();
+
+    // Vrai si le thread d'écriture attend un nouvel état
+    bool ready() const;
+
+    // Confie un état au thread d'écriture. Un état encore en attente est
+    // remplacé : sous charge, on saute des générations plutôt que de ralentir.
+    void submit(uint64_t generation, GridSnapshot snapshot);
+
+    // Le prochain enregistrement sera un keyframe (nouvelle partie, chargement...)
+    void restart();
+
+private:
+    std::string path;
+    uint64_t keyframe_interval;
+    uint64_t bytes_per_second;
+
+    std::thread worker;
+    mutable std::mutex mutex;
+    std::condition_variable wake;
+    bool stopping = false;
+    bool has_pending = false;
+    bool writing = false;
+    bool restart_requested = true;
+    uint64_t pending_generation = 0;
+    GridSnapshot pending;
+
+    // État du thread d'écriture : dernières tuiles journalisées, triées, et
+    // dernière règle
+    std::vector<Tile> previous[2];
+    RuleSet previous_rule = RuleSet::COUNT;
+    uint64_t records_since_keyframe = 0;
+
+    void run();
+    void write(uint64_t generation, const GridSnapshot& snapshot, bool keyframe);
+};
+
+// Rejoue le journal ; faux s'il n'existe pas ou ne commence pas par un keyframe
+bool readJournal(const std::string& path, GridSnapshot& snapshot, uint64_t& generation);
+
+#endif
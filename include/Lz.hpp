@@ -0,0 +1,22 @@
+#ifndef LZ_HPP
+#define LZ_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Petit codec LZ77 dans l'esprit de LZ4, pour les blocs de tuiles des
+// sauvegardes et du journal. Chaque bloc se décompresse seul.
+//
+// Séquence : jeton (4 bits longueur de littéraux, 4 bits longueur de copie - 4),
+// octets d'extension (255...) si un champ vaut 15, littéraux, distance sur
+// 2 octets, extension de la longueur de copie. La dernière séquence n'a que
+// des littéraux ; la taille décompressée est connue de l'appelant.
+
+// Ajoute à out la version compressée de src
+void lzCompress(const uint8_t* src, size_t size, std::vector<uint8_t>& out);
+
+// Faux si le bloc est corrompu ou ne fait pas exactement raw_size octets
+bool lzDecompress(const uint8_t* src, size_t size, uint8_t* dst, size_t raw_size);
+
+#endif
@@ -0,0 +1,53 @@
+#ifndef METRICS_HPP
+#define METRICS_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include "Grid.hpp"
+
+// Compteurs et jauges pour les longues sessions, écrits régulièrement dans un
+// fichier au format texte Prometheus (collecteur "textfile" de node_exporter,
+// ou tout outil qui sait lire ce format). Le fichier est écrit à côté puis
+// renommé : un lecteur ne voit jamais un fichier à moitié écrit.
+//
+//   shinra_generation, shinra_population, shinra_tiles, shinra_evicted_tiles
+//   shinra_births_total, shinra_deaths_total (et par génération)
+//   shinra_step_seconds (histogramme, durée d'une génération)
+//   shinra_history_bytes
+//   process_resident_memory_bytes, process_cpu_seconds_total, process_threads
+//   shinra_thread_utilization (temps CPU / (temps écoulé x nombre de coeurs))
+
+class MetricsFile {
+public:
+    static const int STEP_BUCKETS = 12;
+
+    MetricsFile(const std::string& path, double interval_seconds = 10.0);
+
+    // Durée d'un pas de `generations` générations
+    void observeStep(uint64_t generations, double seconds);
+    void setHistoryBytes(uint64_t bytes);
+
+    // Écrit le fichier si l'intervalle est écoulé (ou tout de suite avec
+    // force). Renvoie false si l'écriture a échoué.
+    bool update(const Grid& grid, uint64_t generation, bool force = false);
+
+private:
+    std::string path;
+    std::chrono::steady_clock::duration interval;
+    std::chrono::steady_clock::time_point lastWrite;
+
+    uint64_t stepCounts[STEP_BUCKETS + 1] = {}; // Dernière case : +Inf
+    uint64_t stepCount = 0;
+    double stepSum = 0.0;
+    uint64_t historyBytes = 0;
+
+    // Valeurs à la dernière écriture, pour les taux
+    uint64_t lastGeneration = 0;
+    uint64_t lastBirths = 0;
+    uint64_t lastDeaths = 0;
+    double lastCpuSeconds = 0.0;
+    bool written = false;
+};
+
+#endif
@@ -0,0 +1,53 @@
+#ifndef PATTERNIO_HPP
+#define PATTERNIO_HPP
+
+#include <atomic>
+#include <string>
+#include <vector>
+#include "Grid.hpp"
+#include "Tile.hpp"
+
+// Format RLE standard de Life :
+//   #CXRLE Pos=x,y        (optionnel, position du coin haut-gauche)
+//   x = 3, y = 3, rule = B3/S23
+//   bo$2bo$3o!
+//
+// Le fichier est lu par blocs et décodé à la volée directement dans la liste
+// de cellules, triée une seule fois à la fin.
+bool readRLE(const std::string& filename, std::vector<Cell>& cells, RuleSet& rule);
+// progress (optionnel) avance de 0 à 1 pendant l'écriture
+bool writeRLE(const std::string& filename, const std::vector<Cell>& cells, RuleSet rule,
+              std::atomic<float>* progress = nullptr);
+
+// Format texte .cells : lignes de '.' (morte) et 'O' (vivante), commentaires '!'
+//   !Name: Glider
+//   .O
+//   ..O
+//   OOO
+bool readCells(const std::string& filename, std::vector<Cell>& cells);
+
+// Format macrocell de Golly (.mc) : un quadtree où les sous-arbres identiques
+// ne sont écrits qu'une fois.
+//   [M2] (golly 2.0)
+//   #R B3/S23
+//   .*$..*$***$          (feuille 8x8, '.' morte, '*' vivante, '$' fin de rangée)
+//   4 0 1 0 1            (noeud de niveau 4 : fils nw ne sw se, 0 = vide)
+// La racine (dernier noeud) est centrée sur l'origine. Toute la table de noeuds
+// est validée (et les tuiles comptées) avant de produire la moindre tuile :
+// le quadtree est développé jusqu'aux noeuds de 64x64, recopiés directement
+// en tuiles (Tile.hpp), sans liste de cellules. Au-delà de
+// MACROCELL_MAX_TILES tuiles non vides (environ 2 Gio), le fichier est
+// refusé : quelques lignes suffisent à décrire un univers astronomique.
+static const uint64_t MACROCELL_MAX_TILES = 1ULL << 22;
+bool readMacrocell(const std::string& filename, std::vector<Tile>& tiles, RuleSet& rule);
+bool writeMacrocell(const std::string& filename, const std::vector<Cell>& cells, RuleSet rule,
+                    std::atomic<float>* progress = nullptr);
+
+// Règle au format "B3/S23" (ou "23/3"), vrai si elle correspond à un RuleSet connu
+bool parseRule(const std::string& text, RuleSet& rule);
+const char* ruleString(RuleSet rule);
+
+// Vrai si filename se termine par extension (sans tenir compte de la casse)
+bool hasExtension(const std::string& filename, const std::string& extension);
+
+#endif
@@ -0,0 +1,61 @@
+#ifndef PATTERNLIBRARY_HPP
+#define PATTERNLIBRARY_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Grid.hpp"
+#include "Tile.hpp"
+
+// Bibliothèque de motifs : tous les .rle et .cells d'un dossier (sous-dossiers
+// compris). Les motifs lus sont gardés en tuiles avec leurs métadonnées dans
+// un fichier d'index ; au scan suivant, seuls les fichiers dont la taille ou
+// la date a changé sont relus.
+//
+// Index : "SHPATIDX", version, nombre d'entrées, puis pour chaque entrée le
+// chemin, la taille et la date du fichier, les métadonnées et les tuiles
+// compressées (Lz.hpp).
+
+static const char PATTERN_INDEX_MAGIC[8] = { 'S', 'H', 'P', 'A', 'T', 'I', 'D', 'X' };
+static const uint32_t PATTERN_INDEX_VERSION = 1;
+
+struct PatternEntry {
+    std::string path;
+    std::string name; // Nom du fichier sans extension
+    int64_t mtime = 0;
+    uint64_t size = 0;
+    bool valid = false; // Faux si le fichier n'a pas pu être lu
+    RuleSet rule = RuleSet::CONWAY;
+    uint64_t population = 0;
+    int64_t min_x = 0, min_y = 0, max_x = 0, max_y = 0;
+    std::vector<Tile> tiles;
+};
+
+class PatternLibrary {
+public:
+    // index_path vide : directory/.index
+    explicit PatternLibrary(const std::string& directory, const std::string& index_path = "");
+
+    // Relit le dossier ; les fichiers nouveaux ou modifiés sont analysés en
+    // parallèle (thread_count = 0 : un thread par coeur) et l'index est
+    // réécrit s'il a changé. Renvoie le nombre de fichiers analysés.
+    size_t scan(unsigned thread_count = 0);
+
+    // Tous les fichiers trouvés, triés par chemin (valid indique s'ils sont lisibles)
+    const std::vector<PatternEntry>& patterns() const;
+
+    // Cellules du motif, déplacées pour que le coin haut-gauche de sa boîte
+    // englobante soit en (x, y) ; le lot n'est pas trié (voir Grid::stampCells)
+    void patternCells(size_t index, int64_t x, int64_t y, std::vector<Cell>& out) const;
+
+private:
+    std::string directory;
+    std::string index_path;
+    bool index_loaded = false;
+    std::vector<PatternEntry> entries;
+
+    bool loadIndex();
+    bool saveIndex() const;
+};
+
+#endif
@@ -0,0 +1,130 @@
+#ifndef RECORDING_HPP
+#define RECORDING_HPP
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Grid.hpp"
+#include "Journal.hpp"
+#include "Tile.hpp"
+
+// Enregistrement d'une simulation : une frame par génération, dans le format
+// d'enregistrement du journal (Journal.hpp).
+//
+//   RecordingHeader
+//   enregistrements (keyframe toutes les keyframe_interval frames, deltas sinon)
+//   RecordingIndexEntry[index_count]         (une entrée par keyframe)
+//   RecordingFooter
+//
+// L'index permet d'aller à n'importe quelle frame en relisant au plus
+// keyframe_interval enregistrements. Un fichier sans pied de page (arrêt
+// brutal) reste lisible : l'index est alors reconstruit en parcourant les
+// en-têtes.
+
+static const char RECORDING_MAGIC[8] = { 'S', 'H', 'I', 'N', 'R', 'A', 'R', 'C' };
+static const char RECORDING_INDEX_MAGIC[8] = { 'S', 'H', 'R', 'C', 'I', 'N', 'D', 'X' };
+static const uint32_t RECORDING_VERSION = 1;
+
+struct RecordingHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t keyframe_interval;
+};
+
+struct RecordingIndexEntry {
+    uint64_t frame;
+    uint64_t offset; // Position du keyframe dans le fichier
+};
+
+struct RecordingFooter {
+    uint64_t index_offset;
+    uint64_t index_count;
+    uint64_t frame_count;
+    char magic[8];
+};
+
+// Frames confiées au thread d'écriture et pas encore écrites ; au-delà,
+// append attend (aucune frame n'est sautée)
+static const size_t RECORDING_QUEUE_FRAMES = 8;
+
+// Les frames sont comparées, compressées et écrites par un thread à part,
+// comme les sauvegardes et le journal : append ne fait qu'une copie figée de
+// la grille (Grid::snapshot).
+class RecordingWriter {
+public:
+    RecordingWriter(const std::string& path, uint32_t keyframe_interval = 64);
+    ~RecordingWriter();
+
+    // Faux dès qu'une écriture a échoué
+    bool good() const;
+    // Frames ajoutées, écrites ou non
+    uint64_t frameCount() const;
+
+    // Ajoute l'état courant de la grille comme frame suivante
+    bool append(uint64_t generation, const Grid& grid);
+
+    // Attend l'écriture des frames en attente puis écrit l'index ; appelé
+    // par le destructeur si besoin
+    bool finish();
+
+private:
+    std::ofstream out;
+    uint32_t keyframe_interval;
+    uint64_t frame_count = 0;
+    bool finished = false;
+
+    std::thread worker;
+    mutable std::mutex mutex;
+    std::condition_variable wake;  // Une frame attend, ou finish()
+    std::condition_variable space; // Une place s'est libérée dans la file
+    std::deque<GridSnapshot> queue;
+    bool stopping = false;
+    bool failed = false;
+
+    // État du thread d'écriture
+    uint64_t written_frames = 0;
+    std::vector<RecordingIndexEntry> index;
+    std::vector<Tile> previous[2];
+
+    void run();
+    bool write(const GridSnapshot& snapshot);
+};
+
+class RecordingReader {
+public:
+    bool open(const std::string& path);
+
+    uint64_t frameCount() const;
+    uint64_t frame() const;      // Frame courante
+    uint64_t generation() const; // Génération de la frame courante
+
+    // Se place sur la frame demandée (bornée à la dernière) : repart du
+    // keyframe le plus proche, ou avance depuis la frame courante si c'est
+    // plus court
+    bool seek(uint64_t target);
+
+    void snapshot(GridSnapshot& out) const;
+
+private:
+    std::ifstream in;
+    uint64_t frame_count = 0;
+    std::vector<RecordingIndexEntry> index;
+
+    bool positioned = false;
+    uint64_t current_frame = 0;
+    uint64_t current_generation = 0;
+    RuleSet rules = RuleSet::CONWAY;
+    std::vector<Tile> tiles[2];
+    std::vector<JournalTile> entries;
+
+    bool readFooter();
+    bool rebuildIndex(uint64_t data_start);
+    bool readFrame();
+};
+
+#endif
@@ -0,0 +1,99 @@
+#ifndef SAVEFILE_HPP
+#define SAVEFILE_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Grid.hpp"
+#include "Tile.hpp"
+
+// Format de sauvegarde v4, lisible directement via mmap :
+//
+//   SaveHeader
+//   uint8_t thumbnail[64 * 64]               (aperçu en niveaux de gris, v3)
+//   SaveTileEntry[alive_tiles + god_tiles]   (index, tuiles dans l'ordre de Morton)
+//   uint64_t rows[64] par tuile              (bitmaps de 512 octets)
+//
+// Avec SAVE_FLAG_COMPRESSED (v4), les bitmaps sont regroupés par blocs de
+// SAVE_BLOCK_TILES tuiles compressés indépendamment (voir Lz.hpp), ce qui
+// permet de les décompresser en parallèle :
+//
+//   uint64_t block_count                     (à data_offset)
+//   SaveBlockEntry[block_count]
+//   blocs compressés
+//
+// Les offsets de l'index désignent alors une position dans les bitmaps
+// décompressés, mis bout à bout.
+//
+// Tous les champs sont alignés sur 8 octets et écrits dans l'ordre natif ;
+// endian_mark permet de reconnaître un fichier écrit sur l'autre boutisme.
+// Les fichiers v2 (sans génération ni aperçu) et les anciens save.dat (nombre
+// de cellules puis paires d'int32) restent lisibles.
+
+static const char SAVE_MAGIC[8] = { 'S', 'H', 'I', 'N', 'R', 'A', 'S', 'V' };
+static const uint32_t SAVE_VERSION = 4;
+static const int SAVE_THUMBNAIL_SIZE = 64;
+static const uint32_t SAVE_ENDIAN_MARK = 0x01020304;
+static const uint32_t SAVE_FLAG_COMPRESSED = 1;
+static const uint64_t SAVE_BLOCK_TILES = 256; // 128 Ko décompressés par bloc
+
+struct SaveHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t endian_mark;
+    uint32_t rule;
+    uint32_t flags;
+    int64_t min_x, min_y, max_x, max_y; // Boîte englobante des cellules vivantes
+    uint64_t population;
+    uint64_t god_count;
+    uint64_t alive_tiles;
+    uint64_t god_tiles;
+    uint64_t index_offset;
+    uint64_t data_offset;
+    // Ajouté en v3
+    uint64_t generation;
+    uint64_t thumbnail_offset;
+};
+
+// Métadonnées d'une sauvegarde, lues sans charger les cellules
+struct SaveInfo {
+    uint32_t version; // 0 pour l'ancien format
+    RuleSet rule;
+    uint64_t population;
+    uint64_t generation;
+    int64_t min_x, min_y, max_x, max_y;
+    bool has_thumbnail;
+    uint8_t thumbnail[SAVE_THUMBNAIL_SIZE * SAVE_THUMBNAIL_SIZE];
+};
+
+struct SaveTileEntry {
+    int64_t tx, ty;
+    uint64_t offset; // Position du bitmap depuis le début du fichier
+};
+
+struct SaveBlockEntry {
+    uint64_t offset; // Position du bloc compressé dans le fichier
+    uint64_t size;
+    uint64_t raw_size;
+};
+
+// Tuiles dans l'ordre de Morton (cellsToTiles, GridEngine::saveTiles).
+// progress (optionnel) avance de 0 à 1 pendant l'écriture. Sans compression,
+// les bitmaps restent utilisables tels quels depuis le fichier mappé.
+bool writeSaveFile(const std::string& filename, const std::vector<Tile>& aliveTiles,
+                   const std::vector<Tile>& godTiles, RuleSet rule, uint64_t generation,
+                   bool compress = true, std::atomic<float>* progress = nullptr);
+
+// Les listes sont remplies triées ; rule et generation ne sont modifiés que si
+// le fichier les contient. Les tuiles sont décodées sur plusieurs threads.
+bool readSaveFile(const std::string& filename, std::vector<Cell>& alive,
+                  std::vector<Cell>& god, RuleSet& rule, uint64_t* generation = nullptr);
+
+// Force l'écriture du fichier sur le disque (fsync), avant de le renommer
+bool syncFile(const std::string& filename);
+
+// Ne lit que l'en-tête et l'aperçu (quelques Ko), quelle que soit la taille du fichier
+bool readSaveInfo(const std::string& filename, SaveInfo& info);
+
+#endif
@@ -0,0 +1,32 @@
+#ifndef SETENGINE_HPP
+#define SETENGINE_HPP
+
+#include <set>
+#include "GridEngine.hpp"
+
+// Moteur le plus simple : un std::set (ordre de Morton de Cell) et une
+// std::map des voisins à chaque génération. Lent, mais facile à relire :
+// sert de point de comparaison aux autres.
+class SetEngine : public GridEngine {
+public:
+    EngineKind kind() const override;
+    std::unique_ptr<GridEngine> clone() const override;
+
+    void setCell(int64_t x, int64_t y, bool alive) override;
+    bool isAlive(int64_t x, int64_t y) const override;
+    void clear() override;
+    void addCells(std::vector<Cell>& cells) override;
+    void load(std::vector<Cell> cells) override;
+    void save(std::vector<Cell>& out) const override;
+    bool step(RuleSet rule, const std::vector<Cell>& god, uint64_t& births) override;
+    void getCellsInRect(int64_t x0, int64_t y0, int64_t x1, int64_t y1, std::vector<Cell>& out) const override;
+    size_t population() const override;
+    bool bounds(int64_t& min_x, int64_t& min_y, int64_t& max_x, int64_t& max_y) const override;
+    size_t tileCount() const override;
+    size_t memoryUsage() const override;
+
+private:
+    std::set<Cell> cells;
+};
+
+#endif
@@ -0,0 +1,40 @@
+#ifndef SPARSEENGINE_HPP
+#define SPARSEENGINE_HPP
+
+#include "GridEngine.hpp"
+
+// Moteur d'origine : cellules vivantes dans un tableau trié (ordre de Morton),
+// chaque génération compte les voisins en triant les "votes" des cellules
+class SparseEngine : public GridEngine {
+public:
+    EngineKind kind() const override;
+    std::unique_ptr<GridEngine> clone() const override;
+
+    void setCell(int64_t x, int64_t y, bool alive) override;
+    bool isAlive(int64_t x, int64_t y) const override;
+    void clear() override;
+    void addCells(std::vector<Cell>& cells) override;
+    void load(std::vector<Cell> cells) override;
+    void save(std::vector<Cell>& out) const override;
+    const std::vector<Cell>* sortedCells() const override;
+    bool step(RuleSet rule, const std::vector<Cell>& god, uint64_t& births) override;
+    void getCellsInRect(int64_t x0, int64_t y0, int64_t x1, int64_t y1, std::vector<Cell>& out) const override;
+    size_t population() const override;
+    bool bounds(int64_t& min_x, int64_t& min_y, int64_t& max_x, int64_t& max_y) const override;
+    size_t tileCount() const override;
+    size_t memoryUsage() const override;
+
+private:
+    std::vector<Cell> aliveCells;
+
+    // Tampons réutilisés d'une génération à l'autre : une fois leur capacité
+    // atteinte, step() ne fait plus aucune allocation.
+    std::vector<Cell> neighborBuffer;
+    std::vector<Cell> nextBuffer;
+
+    void collectQuadrant(uint64_t qx, uint64_t qy, int level,
+                         uint64_t x0, uint64_t y0, uint64_t x1, uint64_t y1,
+                         std::vector<Cell>& out) const;
+};
+
+#endif
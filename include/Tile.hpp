@@ -0,0 +1,25 @@
+#ifndef TILE_HPP
+#define TILE_HPP
+
+#include <cstdint>
+#include <vector>
+#include "Grid.hpp"
+
+// Bloc de 64x64 cellules : une rangée de 64 bits par ligne,
+// le bit c de rows[r] est la cellule (tx * 64 + c, ty * 64 + r).
+static const int TILE_SIZE = 64;
+
+struct Tile {
+    int64_t tx, ty;
+    uint64_t rows[TILE_SIZE];
+};
+
+// Découpe une liste de cellules triée (ordre de Morton) en tuiles. Une tuile
+// est un carré aligné : ses cellules sont contiguës et les tuiles sortent
+// elles aussi dans l'ordre de Morton.
+void cellsToTiles(const std::vector<Cell>& cells, std::vector<Tile>& tiles);
+
+// Ajoute à out les cellules d'une tuile, dans l'ordre de Morton
+void appendTileCells(int64_t tx, int64_t ty, const uint64_t* rows, std::vector<Cell>& out);
+
+#endif
@@ -0,0 +1,52 @@
+#ifndef TILESTORE_HPP
+#define TILESTORE_HPP
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "Tile.hpp"
+
+// Fichier d'échange des tuiles (TiledEngine::setBudget) : les tuiles
+// endormies y sont recopiées pour libérer la mémoire, dans des blocs de
+// STORE_CHUNK_TILES tuiles projetés en mémoire (mmap) et jamais déplacés.
+// Le fichier est supprimé dès sa création : il disparaît avec le processus.
+//
+// Une tuile rangée reste lisible par un simple pointeur ; c'est le noyau qui
+// la relit depuis le disque quand on y touche. Libérer le dernier shared_ptr
+// qui la tient rend sa place au fichier, depuis n'importe quel thread.
+static const size_t STORE_CHUNK_TILES = 8192; // 8192 * sizeof(Tile) : un multiple de 4096
+
+class TileStore : public std::enable_shared_from_this<TileStore> {
+public:
+    // Crée le fichier dans directory ; nullptr en cas d'échec
+    static std::shared_ptr<TileStore> create(const std::string& directory);
+    ~TileStore();
+
+    TileStore(const TileStore&) = delete;
+    TileStore& operator=(const TileStore&) = delete;
+
+    // Copie la tuile dans le fichier ; nullptr si le fichier ne peut plus grandir
+    std::shared_ptr<Tile> store(const Tile& tile);
+
+    // Rend au système les pages de ces tuiles rangées (store), triées au
+    // passage : elles ne comptent plus dans la mémoire résidente du
+    // processus, et seront relues du disque au besoin
+    void dropResident(std::vector<const Tile*>& tiles);
+
+    size_t storedTiles() const;
+    size_t fileBytes() const;
+
+private:
+    explicit TileStore(int fd);
+
+    int fd;
+    mutable std::mutex mutex;
+    std::vector<Tile*> chunks;
+    std::vector<size_t> freeSlots;
+    size_t used = 0;
+
+    void release(size_t slot);
+};
+
+#endif
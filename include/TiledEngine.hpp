@@ -0,0 +1,109 @@
+#ifndef TILEDENGINE_HPP
+#define TILEDENGINE_HPP
+
+#include <memory>
+#include "GridEngine.hpp"
+#include "Tile.hpp"
+#include "TileStore.hpp"
+
+// Tuiles 64x64 (Tile.hpp) rangées dans l'ordre de Morton. Une génération
+// calcule chaque rangée de 64 cellules d'un coup : les 8 voisins sont
+// additionnés bit à bit dans un compteur de 4 bits par cellule. Seules les
+// tuiles dont le voisinage a changé à la génération précédente sont
+// calculées (les autres dorment : leur état suivant est leur état actuel),
+// réparties entre les coeurs quand elles sont nombreuses.
+//
+// Les tuiles sont partagées et copiées à l'écriture : clone() ne copie que
+// les pointeurs, et une tuile encore tenue par une copie est dupliquée avant
+// d'être modifiée. Une tuile qui ne change pas d'une génération à l'autre
+// reste la même, si bien que l'historique ne paie que les tuiles actives.
+//
+// Avec un budget (setBudget), les tuiles endormies depuis
+// TILE_EVICT_GENERATIONS générations partent dans le fichier d'échange,
+// les plus anciennes d'abord, dès que les tuiles en mémoire dépassent le
+// budget. Elles reviennent en mémoire quand l'activité les atteint.
+static const uint64_t TILE_EVICT_GENERATIONS = 16;
+
+class TiledEngine : public GridEngine {
+public:
+    EngineKind kind() const override;
+    std::unique_ptr<GridEngine> clone() const override;
+
+    void setCell(int64_t x, int64_t y, bool alive) override;
+    bool isAlive(int64_t x, int64_t y) const override;
+    void clear() override;
+    void addCells(std::vector<Cell>& cells) override;
+    void load(std::vector<Cell> cells) override;
+    void save(std::vector<Cell>& out) const override;
+    void saveTiles(std::vector<Tile>& out) const override;
+    void loadTiles(std::vector<Tile> tiles) override;
+    bool step(RuleSet rule, const std::vector<Cell>& god, uint64_t& births) override;
+    void getCellsInRect(int64_t x0, int64_t y0, int64_t x1, int64_t y1, std::vector<Cell>& out) const override;
+    size_t population() const override;
+    bool bounds(int64_t& min_x, int64_t& min_y, int64_t& max_x, int64_t& max_y) const override;
+    size_t tileCount() const override;
+    size_t memoryUsage() const override;
+    void setBudget(size_t bytes, std::shared_ptr<TileStore> store) override;
+    size_t evictedTiles() const override;
+
+private:
+    // Une tuile tenue par plusieurs moteurs (use_count() > 1) n'est plus
+    // jamais modifiée, pas plus qu'une tuile rangée dans le fichier
+    using TileRef = std::shared_ptr<Tile>;
+
+    struct TileEntry {
+        TileRef tile;
+        uint64_t changed = 0; // Génération (generation) du dernier changement
+        bool stored = false;  // Dans le fichier d'échange
+    };
+
+    // Tuile qui a changé pendant step(), fusionnée dans tiles après le
+    // dernier lot ; tile est nul si elle est devenue vide
+    struct TileUpdate {
+        Cell coord;
+        TileRef tile;
+    };
+
+    // Tuiles non vides, triées
+    std::vector<TileEntry> tiles;
+    size_t count = 0;       // Cellules vivantes
+    uint64_t generation = 0;
+
+    // Tuiles à calculer à la prochaine génération (doublons possibles) :
+    // celles qui ont changé, et leurs voisines du côté des bords qui ont changé
+    std::vector<Cell> pending;
+    // Règle et cellules Dieu de la dernière génération ; si elles changent,
+    // tout est recalculé
+    RuleSet lastRule = RuleSet::COUNT;
+    std::vector<Cell> lastGod;
+
+    size_t budget = 0; // Octets de tuiles en mémoire ; 0 : pas de limite
+    std::shared_ptr<TileStore> store;
+    size_t storedCount = 0;
+    uint64_t evictScan = 0; // Pas de recherche de tuiles à ranger avant cette génération
+
+    // Réutilisés d'une génération à l'autre
+    std::vector<Cell> candidates; // Coordonnées des tuiles à calculer
+    std::vector<Tile> nextTiles;  // Tuiles calculées, avant d'être rangées dans nextEntries
+    std::vector<TileUpdate> updates;
+    std::vector<TileEntry> nextEntries;
+    std::vector<TileRef> spare;   // Tuiles libérées, qui ne sont plus partagées
+
+    // Tuile à remplir, recyclée si possible (contenu indéterminé)
+    TileRef newTile();
+    // La tuile, ramenée en mémoire et dupliquée d'abord si besoin
+    Tile& writable(TileEntry& entry);
+    // Rend la tuile ; gardée pour newTile si personne d'autre ne la tient
+    void release(TileEntry& entry);
+
+    const Tile* find(int64_t tx, int64_t ty) const;
+    // La tuile et ses 8 voisines seront calculées à la prochaine génération
+    void touch(int64_t tx, int64_t ty);
+    void touchAll();
+    // Calcule la tuile (tx, ty) de la génération suivante dans out
+    void computeTile(int64_t tx, int64_t ty, RuleSet rule, const std::vector<Cell>& god, Tile& out) const;
+    // Range des tuiles endormies tant que le budget est dépassé
+    void evict();
+};
+
+#endif
@@ -0,0 +1,55 @@
+#ifndef TRACE_HPP
+#define TRACE_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+// Zones de mesure légères pour le format Chrome trace (ouvrable dans Perfetto
+// ou chrome://tracing) :
+//
+//   void Grid::advance() {
+//       TRACE_ZONE("Grid::advance");
+//       ...
+//   }
+//
+// Chaque thread écrit dans son propre tampon circulaire, sans verrou : on
+// garde les derniers TRACE_BUFFER_EVENTS événements par thread, et
+// writeChromeTrace() peut les relire à tout moment depuis un autre thread.
+
+static const size_t TRACE_BUFFER_EVENTS = 1 << 15;
+
+extern std::atomic<bool> traceEnabled;
+
+// Horloge monotone, en nanosecondes
+uint64_t traceNow();
+
+// Ajoute une zone terminée au tampon du thread appelant ; name doit rester
+// valide jusqu'à l'export (en pratique une chaîne littérale)
+void traceRecord(const char* name, uint64_t start_ns, uint64_t end_ns);
+
+// Écrit les événements des `seconds` dernières secondes (0 : tout ce qui reste
+// dans les tampons) au format JSON "traceEvents"
+bool writeChromeTrace(const std::string& path, double seconds = 0.0);
+
+class TraceZone {
+public:
+    explicit TraceZone(const char* name)
+        : name(name), start(traceEnabled.load(std::memory_order_relaxed) ? traceNow() : 0) {}
+    ~TraceZone() {
+        if (start) traceRecord(name, start, traceNow());
+    }
+
+    TraceZone(const TraceZone&) = delete;
+    TraceZone& operator=(const TraceZone&) = delete;
+
+private:
+    const char* name;
+    uint64_t start;
+};
+
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+#define TRACE_ZONE(name) TraceZone TRACE_CONCAT(traceZone_, __LINE__)(name)
+
+#endif
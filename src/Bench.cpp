@@ -0,0 +1,77 @@
+#include "Bench.hpp"
+#include "Check.hpp"
+#include "FrameExport.hpp"
+#include "Grid.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <string>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double secondsSince(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// Avance génération par génération pour compter les cellules traitées
+void benchSteps(const char* name, Grid& grid, uint64_t generations, std::ostream& out) {
+    uint64_t cells = 0;
+    auto start = Clock::now();
+    for (uint64_t i = 0; i < generations; ++i) {
+        cells += grid.population();
+        grid.step(1);
+    }
+    double seconds = secondsSince(start);
+    out << "bench " << name << " gen_per_s=" << generations / seconds << " cells_per_s=" << cells / seconds
+        << " ms=" << seconds * 1000.0 << std::endl;
+}
+
+}
+
+void runBenchmarks(std::ostream& out, bool autoEngine, EngineKind engine) {
+    out << "engine " << (autoEngine ? "auto" : engineName(engine)) << std::endl;
+    {
+        Grid grid;
+        if (!autoEngine) grid.setEngine(engine);
+        grid.randomize(256, 256, -128, -128, 1, 0.35);
+        benchSteps("soup", grid, 200, out);
+    }
+    {
+        Grid grid;
+        if (!autoEngine) grid.setEngine(engine);
+        for (const auto& pattern : knownPatterns()) {
+            if (std::string(pattern.name) == "gosper-gun") placePattern(pattern, grid, 0, 0);
+        }
+        benchSteps("gun", grid, 2000, out);
+    }
+    {
+        // Dessin et encodage GIF d'une soupe qui évolue, dans un fichier temporaire
+        Grid grid;
+        if (!autoEngine) grid.setEngine(engine);
+        grid.randomize(256, 256, -128, -128, 2, 0.35);
+        FrameView view;
+        view.x = view.y = -160;
+        view.width = view.height = 320;
+        view.zoom = 2.0;
+        std::string path = (std::filesystem::temp_directory_path() / "shinra_bench.gif").string();
+        const int frames = 100;
+        std::vector<uint8_t> pixels;
+        std::vector<Cell> scratch;
+        auto start = Clock::now();
+        {
+            FrameExporter exporter(path, view.pixelWidth(), view.pixelHeight(), 40);
+            for (int frame = 0; frame < frames; ++frame) {
+                rasterizeFrame(grid, view, pixels, scratch);
+                exporter.addFrame(std::move(pixels));
+                grid.step(1);
+            }
+            exporter.finish();
+        }
+        double seconds = secondsSince(start);
+        std::remove(path.c_str());
+        out << "bench render frames_per_s=" << frames / seconds << " ms=" << seconds * 1000.0 << std::endl;
+    }
+}
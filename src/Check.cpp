@@ -0,0 +1,442 @@
+#include "Check.hpp"
+#include "Grid.hpp"
+#include "GridEngine.hpp"
+#include "Tile.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <iterator>
+#include <random>
+#include <set>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace {
+
+using Coord = std::pair<int64_t, int64_t>;
+
+// Référence : aucune optimisation, une règle lisible telle quelle
+class ReferenceGrid {
+public:
+    std::set<Coord> alive;
+    std::set<Coord> god;
+    RuleSet rule = RuleSet::CONWAY;
+
+    // Chaque voisin est noté une fois par cellule vivante autour de lui :
+    // après le tri, la longueur de ses répétitions est son nombre de voisins
+    void step() {
+        std::vector<Coord> neighbors;
+        neighbors.reserve(alive.size() * 8);
+        for (const auto& cell : alive) {
+            for (int dx = -1; dx <= 1; dx++) {
+                for (int dy = -1; dy <= 1; dy++) {
+                    if (dx != 0 || dy != 0) neighbors.push_back({cell.first + dx, cell.second + dy});
+                }
+            }
+        }
+        std::sort(neighbors.begin(), neighbors.end());
+        std::set<Coord> next;
+        for (size_t i = 0, j; i < neighbors.size(); i = j) {
+            for (j = i + 1; j < neighbors.size() && neighbors[j] == neighbors[i]; ++j) {}
+            bool isAlive = alive.count(neighbors[i]) != 0;
+            size_t n = j - i;
+            bool born = n == 3 || (rule == RuleSet::HIGHLIFE && n == 6);
+            if ((isAlive && (n == 2 || n == 3)) || (!isAlive && born)) next.insert(next.end(), neighbors[i]);
+        }
+        // Une cellule Dieu garde son état
+        for (const auto& cell : god) {
+            if (alive.count(cell)) next.insert(cell);
+            else next.erase(cell);
+        }
+        alive.swap(next);
+    }
+};
+
+uint64_t mix(uint64_t v) {
+    v ^= v >> 33;
+    v *= 0xff51afd7ed558ccdULL;
+    v ^= v >> 33;
+    v *= 0xc4ceb9fe1a85ec53ULL;
+    return v ^ (v >> 33);
+}
+
+// Empreinte indépendante de l'ordre de parcours
+uint64_t cellHash(int64_t x, int64_t y) {
+    return mix(static_cast<uint64_t>(x) * 0x9E3779B97F4A7C15ULL ^ mix(static_cast<uint64_t>(y)));
+}
+
+uint64_t cellsHash(const std::vector<Cell>& cells) {
+    uint64_t hash = 0;
+    for (const auto& cell : cells) hash += cellHash(cell.x, cell.y);
+    return hash;
+}
+
+uint64_t gridHash(const Grid& grid) {
+    return cellsHash(grid.getAliveCells());
+}
+
+uint64_t referenceHash(const ReferenceGrid& reference) {
+    uint64_t hash = 0;
+    for (const auto& cell : reference.alive) hash += cellHash(cell.first, cell.second);
+    return hash;
+}
+
+// Première cellule présente d'un seul côté
+std::string describeDifference(const Grid& grid, const ReferenceGrid& reference) {
+    std::set<Coord> cells;
+    for (const auto& cell : grid.getAliveCells()) cells.insert({cell.x, cell.y});
+    for (const auto& cell : cells) {
+        if (!reference.alive.count(cell)) {
+            return "extra cell (" + std::to_string(cell.first) + ", " + std::to_string(cell.second) + ")";
+        }
+    }
+    for (const auto& cell : reference.alive) {
+        if (!cells.count(cell)) {
+            return "missing cell (" + std::to_string(cell.first) + ", " + std::to_string(cell.second) + ")";
+        }
+    }
+    return "same cells, duplicate or unsorted entries in Grid";
+}
+
+struct CheckCase {
+    std::string name;
+    RuleSet rule;
+    const KnownPattern* pattern; // nullptr : soupe aléatoire
+    bool edits;                  // Éditions aléatoires en cours de route
+};
+
+const KnownPattern* findPattern(const std::string& name) {
+    for (const auto& pattern : knownPatterns()) {
+        if (name == pattern.name) return &pattern;
+    }
+    return nullptr;
+}
+
+std::vector<CheckCase> checkCases() {
+    std::vector<CheckCase> cases;
+    for (const auto& pattern : knownPatterns()) cases.push_back({ pattern.name, pattern.rule, &pattern, false });
+    cases.push_back({ "soup", RuleSet::CONWAY, nullptr, false });
+    cases.push_back({ "soup-highlife", RuleSet::HIGHLIFE, nullptr, false });
+    cases.push_back({ "soup-edits", RuleSet::CONWAY, nullptr, true });
+    cases.push_back({ "r-pentomino-edits", RuleSet::CONWAY, findPattern("r-pentomino"), true });
+    cases.push_back({ "soup-highlife-edits", RuleSet::HIGHLIFE, nullptr, true });
+    return cases;
+}
+
+// Cellule existante au hasard (les retraits doivent viser des cellules
+// présentes pour être testés), ou la position tirée si l'ensemble est vide
+Coord pickExisting(std::mt19937_64& rng, const std::set<Coord>& cells, Coord fallback) {
+    if (cells.empty()) return fallback;
+    auto it = cells.begin();
+    std::advance(it, rng() % std::min<size_t>(cells.size(), 256));
+    return *it;
+}
+
+// Une édition tirée au hasard, appliquée aux deux côtés
+void applyRandomEdit(std::mt19937_64& rng, Grid& grid, ReferenceGrid& reference) {
+    std::uniform_int_distribution<int64_t> coord(-48, 48);
+    int64_t x = coord(rng), y = coord(rng);
+    switch (rng() % 4) {
+        case 0:
+        case 1: { // setCell, le plus fréquent
+            bool alive = rng() % 2 == 0;
+            if (!alive) std::tie(x, y) = pickExisting(rng, reference.alive, {x, y});
+            grid.setCell(x, y, alive);
+            if (alive) reference.alive.insert({x, y});
+            else reference.alive.erase({x, y});
+            break;
+        }
+        case 2: {
+            bool isGod = rng() % 3 != 0;
+            if (!isGod) std::tie(x, y) = pickExisting(rng, reference.god, {x, y});
+            grid.setGodCell(x, y, isGod);
+            if (isGod) reference.god.insert({x, y});
+            else reference.god.erase({x, y});
+            break;
+        }
+        case 3: {
+            // Le tirage vient de Grid (une grille vide reçoit la même zone) ;
+            // seule la fusion avec les cellules existantes est vérifiée
+            int width = 1 + static_cast<int>(rng() % 24), height = 1 + static_cast<int>(rng() % 24);
+            uint64_t seed = rng();
+            grid.randomize_selection(x, y, width, height, seed, 0.5);
+            Grid scratch;
+            scratch.randomize_selection(x, y, width, height, seed, 0.5);
+            for (const auto& cell : scratch.getAliveCells()) reference.alive.insert({cell.x, cell.y});
+            break;
+        }
+    }
+}
+
+// Cellules d'un rectangle tiré au hasard, des deux côtés
+bool sameCellsInRect(std::mt19937_64& rng, const Grid& grid, const ReferenceGrid& reference) {
+    std::uniform_int_distribution<int64_t> coord(-80, 80);
+    int64_t x0 = coord(rng), y0 = coord(rng);
+    int64_t x1 = x0 + static_cast<int64_t>(rng() % 100), y1 = y0 + static_cast<int64_t>(rng() % 100);
+    std::vector<Cell> cells;
+    grid.getCellsInRect(x0, y0, x1, y1, cells);
+    std::set<Coord> inRect;
+    for (const auto& cell : cells) inRect.insert({cell.x, cell.y});
+    size_t expected = 0;
+    for (const auto& cell : reference.alive) {
+        if (cell.first < x0 || cell.first > x1 || cell.second < y0 || cell.second > y1) continue;
+        if (!inRect.count(cell)) return false;
+        expected++;
+    }
+    return std::is_sorted(cells.begin(), cells.end()) && cells.size() == expected && inRect.size() == expected;
+}
+
+// autoEngine : la grille part de engine avec le choix automatique actif
+// (EngineSelector.hpp) ; switches reçoit le nombre de changements de moteur
+bool runCase(const CheckCase& test, EngineKind engine, bool autoEngine, uint64_t seed, uint64_t generations,
+             std::ostream& out, int& switches) {
+    std::mt19937_64 rng(seed);
+    Grid grid;
+    grid.setEngine(engine);
+    if (autoEngine) grid.setAutoEngine(true);
+    const char* label = autoEngine ? "auto" : engineName(engine);
+    switches = 0;
+    ReferenceGrid reference;
+    grid.setRuleSet(test.rule);
+    reference.rule = test.rule;
+    if (test.pattern) placePattern(*test.pattern, grid, 0, 0);
+    else grid.randomize(64, 64, -32, -32, rng(), 0.35);
+    for (const auto& cell : grid.getAliveCells()) reference.alive.insert({cell.x, cell.y});
+
+    // Copie prise en cours de route : elle ne doit plus bouger ensuite
+    GridSnapshot held;
+    ReferenceGrid heldReference;
+
+    for (uint64_t generation = 0; generation <= generations; ++generation) {
+        if (generation > 0) {
+            if (test.edits) {
+                for (uint64_t edits = rng() % 4; edits > 0; --edits) applyRandomEdit(rng, grid, reference);
+                // Migration aller-retour vers le moteur suivant, en cours de partie
+                if (!autoEngine && generation == generations / 2) {
+                    int count = static_cast<int>(EngineKind::COUNT);
+                    grid.setEngine(static_cast<EngineKind>((static_cast<int>(engine) + 1) % count));
+                    grid.setEngine(engine);
+                }
+            }
+            EngineKind before = grid.getEngine();
+            grid.step(1);
+            reference.step();
+            if (grid.getEngine() != before) switches++;
+        }
+        bool sorted = std::is_sorted(grid.getAliveCells().begin(), grid.getAliveCells().end());
+        if (!sorted || grid.getAliveCells().size() != reference.alive.size() ||
+            grid.population() != reference.alive.size() || gridHash(grid) != referenceHash(reference)) {
+            out << "FAIL " << test.name << " [" << label << "] at generation " << generation
+                << ": population " << grid.population() << " vs " << reference.alive.size() << ", "
+                << describeDifference(grid, reference) << std::endl;
+            return false;
+        }
+        if (generation % 16 == 0 && !sameCellsInRect(rng, grid, reference)) {
+            out << "FAIL " << test.name << " [" << label << "] at generation " << generation
+                << ": getCellsInRect differs" << std::endl;
+            return false;
+        }
+        if (generation == generations / 4) {
+            held = grid.snapshot();
+            heldReference = reference;
+        }
+    }
+
+    // La copie est intacte, et la grille repart d'elle comme la référence
+    std::vector<Cell> scratch;
+    bool intact = cellsHash(held.cells(scratch)) == referenceHash(heldReference);
+    grid.restore(held);
+    for (int generation = 0; intact && generation < 8; ++generation) {
+        grid.step(1);
+        heldReference.step();
+        intact = gridHash(grid) == referenceHash(heldReference) && grid.population() == heldReference.alive.size();
+    }
+    if (!intact) {
+        out << "FAIL " << test.name << " [" << label << "]: snapshot from generation "
+            << generations / 4 << " changed or restored wrongly" << std::endl;
+        return false;
+    }
+    out << "ok   " << test.name << " [" << label << "] (" << grid.population() << " cells";
+    if (autoEngine) out << ", " << switches << " engine switches";
+    out << ")" << std::endl;
+    return true;
+}
+
+// Champ plus large qu'un lot de TiledEngine::step (plus de 16384 tuiles
+// actives) : un clignotant par tuile, à cheval sur les bords une fois sur
+// deux, et quelques soupes. Trop grand pour la référence naïve, TILED est
+// comparé à SPARSE.
+bool runWideCase(uint64_t seed, std::ostream& out) {
+    const int64_t side = 129; // 16641 tuiles, juste au-dessus d'un lot
+    std::mt19937_64 rng(seed);
+    std::vector<Cell> cells;
+    for (int64_t ty = 0; ty < side; ++ty) {
+        for (int64_t tx = 0; tx < side; ++tx) {
+            int64_t x = tx * TILE_SIZE + ((tx + ty) % 2 ? 62 : 30), y = ty * TILE_SIZE + (ty % 3 ? 31 : 0);
+            for (int64_t dx = 0; dx < 3; ++dx) cells.push_back({x + dx, y});
+        }
+    }
+    Grid tiled, sparse;
+    tiled.setEngine(EngineKind::TILED);
+    sparse.setEngine(EngineKind::SPARSE);
+    for (Grid* grid : {&tiled, &sparse}) grid->stampCells(cells);
+    for (int soup = 0; soup < 4; ++soup) {
+        int64_t x = static_cast<int64_t>(rng() % (side * TILE_SIZE));
+        int64_t y = static_cast<int64_t>(rng() % (side * TILE_SIZE));
+        uint64_t soupSeed = rng();
+        for (Grid* grid : {&tiled, &sparse}) grid->randomize_selection(x, y, 48, 48, soupSeed, 0.35);
+    }
+    for (int generation = 0; generation <= 2; ++generation) {
+        if (generation > 0) {
+            tiled.step(1);
+            sparse.step(1);
+        }
+        if (tiled.population() != sparse.population() || gridHash(tiled) != gridHash(sparse)) {
+            out << "FAIL wide-field [TILED] at generation " << generation << ": population "
+                << tiled.population() << " vs " << sparse.population() << " with SPARSE" << std::endl;
+            return false;
+        }
+    }
+    out << "ok   wide-field [TILED] (" << tiled.population() << " cells, " << tiled.tileCount() << " tiles)" << std::endl;
+    return true;
+}
+
+// Budget mémoire (Grid::setTileBudget) bien plus petit que le motif : un
+// bloc par tuile sur 8x8 tuiles, qui s'endort aussitôt et part dans le
+// fichier d'échange, réveillé ensuite par des soupes et des planeurs. La
+// grille doit suivre une grille TILED sans budget, et une copie prise en
+// cours de route doit rester intacte.
+bool runBudgetCase(uint64_t seed, uint64_t generations, std::ostream& out) {
+    std::mt19937_64 rng(seed);
+    Grid budgeted, unlimited;
+    budgeted.setEngine(EngineKind::TILED);
+    unlimited.setEngine(EngineKind::TILED);
+    if (!budgeted.setTileBudget(16 * sizeof(Tile), std::filesystem::temp_directory_path().string())) {
+        out << "FAIL budget [TILED]: cannot create the tile swap file" << std::endl;
+        return false;
+    }
+    std::vector<Cell> blocks;
+    for (int64_t ty = 0; ty < 8; ++ty) {
+        for (int64_t tx = 0; tx < 8; ++tx) {
+            int64_t x = tx * TILE_SIZE + 40, y = ty * TILE_SIZE + 40;
+            for (int64_t dy = 0; dy < 2; ++dy) {
+                for (int64_t dx = 0; dx < 2; ++dx) blocks.push_back({x + dx, y + dy});
+            }
+        }
+    }
+    for (Grid* grid : {&budgeted, &unlimited}) grid->stampCells(blocks);
+    for (int soup = 0; soup < 4; ++soup) {
+        int64_t x = static_cast<int64_t>(rng() % (8 * TILE_SIZE)), y = static_cast<int64_t>(rng() % (8 * TILE_SIZE));
+        uint64_t soupSeed = rng();
+        for (Grid* grid : {&budgeted, &unlimited}) grid->randomize_selection(x, y, 16, 16, soupSeed, 0.35);
+    }
+    for (int glider = 0; glider < 4; ++glider) {
+        int64_t x = glider * 2 * TILE_SIZE - 64;
+        for (Grid* grid : {&budgeted, &unlimited}) placePattern(*findPattern("glider"), *grid, x, -64);
+    }
+
+    GridSnapshot held;
+    uint64_t heldHash = 0;
+    size_t evicted = 0;
+    for (uint64_t generation = 0; generation <= generations; ++generation) {
+        if (generation > 0) {
+            budgeted.step(1);
+            unlimited.step(1);
+        }
+        evicted = std::max(evicted, budgeted.evictedTiles());
+        if (budgeted.population() != unlimited.population() || gridHash(budgeted) != gridHash(unlimited)) {
+            out << "FAIL budget [TILED] at generation " << generation << ": population "
+                << budgeted.population() << " vs " << unlimited.population() << " without budget" << std::endl;
+            return false;
+        }
+        // La copie tient ses tuiles en mémoire : elle est lâchée à mi-parcours
+        if (generation == generations / 4) {
+            held = budgeted.snapshot();
+            heldHash = gridHash(unlimited);
+        } else if (generation == generations / 2) {
+            std::vector<Cell> scratch;
+            if (cellsHash(held.cells(scratch)) != heldHash) {
+                out << "FAIL budget [TILED]: snapshot from generation " << generations / 4 << " changed" << std::endl;
+                return false;
+            }
+            held = GridSnapshot();
+        }
+    }
+    if (!evicted) {
+        out << "FAIL budget [TILED]: no tile was ever evicted" << std::endl;
+        return false;
+    }
+    out << "ok   budget [TILED] (" << budgeted.population() << " cells, up to " << evicted << " tiles evicted)"
+        << std::endl;
+    return true;
+}
+
+}
+
+const std::vector<KnownPattern>& knownPatterns() {
+    static const std::vector<KnownPattern> patterns = {
+        { "glider", RuleSet::CONWAY, { ".O.", "..O", "OOO" } },
+        { "r-pentomino", RuleSet::CONWAY, { ".OO", "OO.", ".O." } },
+        { "acorn", RuleSet::CONWAY, { ".O.....", "...O...", "OO..OOO" } },
+        { "gosper-gun", RuleSet::CONWAY, {
+            "........................O...........",
+            "......................O.O...........",
+            "............OO......OO............OO",
+            "...........O...O....OO............OO",
+            "OO........O.....O...OO..............",
+            "OO........O...O.OO....O.O...........",
+            "..........O.....O.......O...........",
+            "...........O...O....................",
+            "............OO......................" } },
+        { "replicator", RuleSet::HIGHLIFE, { "..OOO", ".O..O", "O...O", "O..O.", "OOO.." } },
+    };
+    return patterns;
+}
+
+void placePattern(const KnownPattern& pattern, Grid& grid, int64_t x, int64_t y) {
+    std::vector<Cell> cells;
+    for (size_t row = 0; row < pattern.rows.size(); ++row) {
+        for (size_t column = 0; pattern.rows[row][column]; ++column) {
+            if (pattern.rows[row][column] == 'O') {
+                cells.push_back({x + static_cast<int64_t>(column), y + static_cast<int64_t>(row)});
+            }
+        }
+    }
+    grid.stampCells(std::move(cells));
+}
+
+int runDifferentialCheck(uint64_t seed, uint64_t generations, std::ostream& out) {
+    auto start = std::chrono::steady_clock::now();
+    int failures = 0;
+    std::vector<CheckCase> cases = checkCases();
+    int runs = 0, switches = 0;
+    for (int engine = 0; engine < static_cast<int>(EngineKind::COUNT); ++engine) {
+        for (size_t i = 0; i < cases.size(); ++i, ++runs) {
+            if (!runCase(cases[i], static_cast<EngineKind>(engine), false, mix(seed + i), generations, out, switches)) {
+                failures++;
+            }
+        }
+    }
+    // Choix automatique : les mêmes cas, en partant de SPARSE ; le moteur doit
+    // changer au moins une fois en cours de route sur l'ensemble des cas
+    int autoSwitches = 0;
+    for (size_t i = 0; i < cases.size(); ++i, ++runs) {
+        if (!runCase(cases[i], EngineKind::SPARSE, true, mix(seed + i), generations, out, switches)) failures++;
+        autoSwitches += switches;
+    }
+    if (!runWideCase(mix(seed + cases.size()), out)) failures++;
+    if (!runBudgetCase(mix(seed + cases.size() + 1), generations, out)) failures++;
+    runs += 2;
+    if (autoSwitches == 0) {
+        out << "FAIL auto engine selection never switched engines" << std::endl;
+        failures++;
+        runs++;
+    }
+    double elapsed_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    out << runs - failures << "/" << runs << " cases passed, seed " << seed
+        << ", " << generations << " generations, " << elapsed_ms << "ms" << std::endl;
+    return failures;
+}
@@ -0,0 +1,93 @@
+#include "EngineSelector.hpp"
+
+namespace {
+
+const size_t HISTORY_SIZE = 2 * ENGINE_MAX_PERIOD;
+
+}
+
+EngineSelector::EngineSelector(uint64_t interval) : interval(interval ? interval : 1) {
+    history.reserve(HISTORY_SIZE);
+}
+
+bool EngineSelector::observe(size_t population, uint64_t births, uint64_t deaths) {
+    Sample sample = {population, births, deaths};
+    if (history.size() < HISTORY_SIZE) history.push_back(sample);
+    else history[head] = sample;
+    head = (head + 1) % HISTORY_SIZE;
+    return ++generation % interval == 0 || history.size() == ENGINE_FIRST_SAMPLE;
+}
+
+void EngineSelector::reset() {
+    history.clear();
+    head = 0;
+}
+
+const EngineSelector::Sample& EngineSelector::recent(size_t age) const {
+    return history[(head + HISTORY_SIZE - 1 - age) % HISTORY_SIZE];
+}
+
+// Plus petite période p telle que toute la fenêtre se répète avec un
+// décalage de p ; au moins deux périodes complètes sont comparées
+int EngineSelector::findPeriod() const {
+    if (history.size() < HISTORY_SIZE) return 0;
+    for (int p = 1; p <= ENGINE_MAX_PERIOD; ++p) {
+        bool repeats = true;
+        for (size_t age = 0; repeats && age + p < history.size(); ++age) {
+            const Sample& a = recent(age);
+            const Sample& b = recent(age + p);
+            repeats = a.population == b.population && a.births == b.births && a.deaths == b.deaths;
+        }
+        if (repeats) return p;
+    }
+    return 0;
+}
+
+EngineKind EngineSelector::choose(const GridEngine& engine, PatternStats& stats) const {
+    EngineKind current = engine.kind();
+    stats = PatternStats();
+    stats.generation = generation;
+    stats.population = engine.population();
+    stats.tiles = engine.tileCount();
+    int64_t min_x, min_y, max_x, max_y;
+    if (stats.population == 0 || stats.tiles == 0 || !engine.bounds(min_x, min_y, max_x, max_y)) return current;
+
+    double box_tiles = (static_cast<double>(max_x >> 6) - static_cast<double>(min_x >> 6) + 1.0) *
+                       (static_cast<double>(max_y >> 6) - static_cast<double>(min_y >> 6) + 1.0);
+    stats.density = static_cast<double>(stats.population) / (static_cast<double>(stats.tiles) * 4096.0);
+    stats.fill = static_cast<double>(stats.tiles) / box_tiles;
+    uint64_t changes = 0, cells = 0;
+    for (const auto& sample : history) {
+        changes += sample.births + sample.deaths;
+        cells += sample.population;
+    }
+    stats.activity = cells ? static_cast<double>(changes) / static_cast<double>(cells) : 0.0;
+    stats.period = findPeriod();
+
+    // Grille figée : Grid::step s'arrête de lui-même, inutile de migrer.
+    // La période n'influe pas encore sur le choix : elle désignerait un
+    // moteur à mémoïsation (HashLife) s'il y en avait un.
+    if (stats.activity == 0.0) return current;
+
+    EngineKind best = predictCost(EngineKind::TILED, stats) < predictCost(EngineKind::SPARSE, stats)
+                          ? EngineKind::TILED : EngineKind::SPARSE;
+    if (best == current) return current;
+    if (current == EngineKind::SPARSE || current == EngineKind::TILED) {
+        if (predictCost(current, stats) < predictCost(best, stats) * ENGINE_SWITCH_MARGIN) return current;
+    }
+    return best;
+}
+
+double EngineSelector::predictCost(EngineKind kind, const PatternStats& stats) {
+    switch (kind) {
+        case EngineKind::SPARSE:
+            return ENGINE_SPARSE_CELL_US * static_cast<double>(stats.population);
+        case EngineKind::TILED: {
+            // Tuiles isolées : leurs voisines vides sont calculées aussi
+            double per_tile = ENGINE_TILED_TILE_US + (ENGINE_TILED_ISOLATED_TILE_US - ENGINE_TILED_TILE_US) * (1.0 - stats.fill);
+            return per_tile * static_cast<double>(stats.tiles);
+        }
+        default:
+            return 0.0;
+    }
+}
@@ -0,0 +1,443 @@
+#include "FrameExport.hpp"
+#include "PatternIO.hpp"
+#include "Trace.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+// --- Bits et sommes de contrôle ---
+
+// Écrit des bits du poids faible au poids fort (deflate et LZW de GIF)
+struct BitWriter {
+    std::vector<uint8_t>& out;
+    uint64_t bits = 0;
+    int count = 0;
+
+    explicit BitWriter(std::vector<uint8_t>& out) : out(out) {}
+
+    void put(uint32_t value, int n) {
+        bits |= static_cast<uint64_t>(value) << count;
+        count += n;
+        while (count >= 8) {
+            out.push_back(static_cast<uint8_t>(bits));
+            bits >>= 8;
+            count -= 8;
+        }
+    }
+
+    void flush() {
+        if (count > 0) out.push_back(static_cast<uint8_t>(bits));
+        bits = 0;
+        count = 0;
+    }
+};
+
+uint32_t crc32(const uint8_t* data, size_t size, uint32_t crc = 0) {
+    static uint32_t table[256];
+    static bool ready = [] {
+        for (uint32_t n = 0; n < 256; ++n) {
+            uint32_t c = n;
+            for (int k = 0; k < 8; ++k) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            table[n] = c;
+        }
+        return true;
+    }();
+    (void)ready;
+    crc = ~crc;
+    for (size_t i = 0; i < size; ++i) crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+uint32_t adler32(const uint8_t* data, size_t size) {
+    uint32_t a = 1, b = 0;
+    while (size > 0) {
+        size_t chunk = std::min<size_t>(size, 5552); // Pas de débordement avant le modulo
+        for (size_t i = 0; i < chunk; ++i) {
+            a += data[i];
+            b += a;
+        }
+        a %= 65521;
+        b %= 65521;
+        data += chunk;
+        size -= chunk;
+    }
+    return (b << 16) | a;
+}
+
+void put16le(std::vector<uint8_t>& out, uint32_t v) {
+    out.push_back(static_cast<uint8_t>(v));
+    out.push_back(static_cast<uint8_t>(v >> 8));
+}
+
+void put32be(std::vector<uint8_t>& out, uint32_t v) {
+    for (int shift = 24; shift >= 0; shift -= 8) out.push_back(static_cast<uint8_t>(v >> shift));
+}
+
+// --- Deflate (codes de Huffman fixes) et zlib ---
+
+const uint16_t LENGTH_BASE[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+                                   35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+const uint8_t LENGTH_EXTRA[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+                                   3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+const uint16_t DISTANCE_BASE[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+                                     257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145,
+                                     8193, 12289, 16385, 24577 };
+const uint8_t DISTANCE_EXTRA[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+                                     7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+uint32_t reverseBits(uint32_t code, int n) {
+    uint32_t reversed = 0;
+    for (int i = 0; i < n; ++i, code >>= 1) reversed = (reversed << 1) | (code & 1);
+    return reversed;
+}
+
+// Les codes de Huffman s'écrivent bit de poids fort en premier
+void putSymbol(BitWriter& bits, int symbol) {
+    if (symbol < 144) bits.put(reverseBits(0x30 + symbol, 8), 8);
+    else if (symbol < 256) bits.put(reverseBits(0x190 + symbol - 144, 9), 9);
+    else if (symbol < 280) bits.put(reverseBits(symbol - 256, 7), 7);
+    else bits.put(reverseBits(0xC0 + symbol - 280, 8), 8);
+}
+
+void putMatch(BitWriter& bits, size_t length, size_t distance) {
+    int l = static_cast<int>(std::upper_bound(LENGTH_BASE, LENGTH_BASE + 29, length) - LENGTH_BASE) - 1;
+    putSymbol(bits, 257 + l);
+    bits.put(static_cast<uint32_t>(length - LENGTH_BASE[l]), LENGTH_EXTRA[l]);
+    int d = static_cast<int>(std::upper_bound(DISTANCE_BASE, DISTANCE_BASE + 30, distance) - DISTANCE_BASE) - 1;
+    bits.put(reverseBits(d, 5), 5);
+    bits.put(static_cast<uint32_t>(distance - DISTANCE_BASE[d]), DISTANCE_EXTRA[d]);
+}
+
+// Un seul bloc à codes fixes : les images de la grille sont faites de longues
+// plages identiques, qu'une recherche de correspondance simple suffit à réduire
+void zlibCompress(const uint8_t* data, size_t size, std::vector<uint8_t>& out) {
+    const int HASH_BITS = 15;
+    const size_t WINDOW = 32768, MAX_MATCH = 258;
+    out.push_back(0x78);
+    out.push_back(0x01);
+
+    BitWriter bits(out);
+    bits.put(1, 1); // Dernier bloc
+    bits.put(1, 2); // Codes fixes
+    std::vector<uint32_t> head(1 << HASH_BITS, 0); // Position + 1, 0 = vide
+    size_t pos = 0;
+    while (pos < size) {
+        size_t best = 0, distance = 0;
+        if (pos + 3 <= size) {
+            uint32_t h = ((data[pos] << 16 | data[pos + 1] << 8 | data[pos + 2]) * 2654435761u) >> (32 - HASH_BITS);
+            size_t candidate = head[h];
+            head[h] = static_cast<uint32_t>(pos + 1);
+            if (candidate != 0 && pos - (candidate - 1) <= WINDOW) {
+                size_t match = candidate - 1;
+                size_t limit = std::min(MAX_MATCH, size - pos);
+                while (best < limit && data[match + best] == data[pos + best]) best++;
+                distance = pos - match;
+            }
+        }
+        if (best >= 3) {
+            putMatch(bits, best, distance);
+            pos += best;
+        } else {
+            putSymbol(bits, data[pos++]);
+        }
+    }
+    putSymbol(bits, 256);
+    bits.flush();
+    put32be(out, adler32(data, size));
+}
+
+// --- PNG / APNG ---
+
+const uint8_t PNG_SIGNATURE[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+
+void pngChunk(std::vector<uint8_t>& out, const char* type, const std::vector<uint8_t>& data) {
+    put32be(out, static_cast<uint32_t>(data.size()));
+    size_t start = out.size();
+    out.insert(out.end(), type, type + 4);
+    out.insert(out.end(), data.begin(), data.end());
+    put32be(out, crc32(out.data() + start, out.size() - start));
+}
+
+// Signature, IHDR (8 bits indexés) et PLTE ; acTL s'intercale pour un APNG
+void pngHeader(std::vector<uint8_t>& out, int width, int height, const std::vector<uint8_t>* actl) {
+    out.insert(out.end(), PNG_SIGNATURE, PNG_SIGNATURE + 8);
+    std::vector<uint8_t> ihdr;
+    put32be(ihdr, width);
+    put32be(ihdr, height);
+    ihdr.insert(ihdr.end(), { 8, 3, 0, 0, 0 }); // Profondeur, palette, compression, filtre, entrelacement
+    pngChunk(out, "IHDR", ihdr);
+    if (actl) pngChunk(out, "acTL", *actl);
+    std::vector<uint8_t> plte(&FRAME_PALETTE[0][0], &FRAME_PALETTE[0][0] + sizeof(FRAME_PALETTE));
+    pngChunk(out, "PLTE", plte);
+}
+
+std::vector<uint8_t> actlData(uint32_t frames) {
+    std::vector<uint8_t> data;
+    put32be(data, frames);
+    put32be(data, 0); // Boucle infinie
+    return data;
+}
+
+// Lignes précédées du filtre 0, compressées en flux zlib
+std::vector<uint8_t> pngImageData(const std::vector<uint8_t>& pixels, int width, int height) {
+    std::vector<uint8_t> raw;
+    raw.reserve(static_cast<size_t>(width + 1) * height);
+    for (int y = 0; y < height; ++y) {
+        raw.push_back(0);
+        raw.insert(raw.end(), pixels.begin() + static_cast<size_t>(y) * width,
+                   pixels.begin() + static_cast<size_t>(y + 1) * width);
+    }
+    std::vector<uint8_t> compressed;
+    zlibCompress(raw.data(), raw.size(), compressed);
+    return compressed;
+}
+
+// --- GIF ---
+
+// Image complète d'un GIF animé : extension de contrôle (délai), descripteur,
+// pixels compressés en LZW (codes de 3 à 12 bits, palette de 4 couleurs)
+std::vector<uint8_t> gifFrame(const std::vector<uint8_t>& pixels, int width, int height, int delay_ms) {
+    const int MIN_CODE_SIZE = 2;
+    const int CLEAR = 1 << MIN_CODE_SIZE, END = CLEAR + 1, MAX_CODES = 4096;
+
+    std::vector<uint8_t> out = { 0x21, 0xF9, 4, 0x04 }; // Contrôle graphique, image conservée
+    put16le(out, static_cast<uint32_t>((delay_ms + 5) / 10));
+    out.insert(out.end(), { 0, 0, 0x2C });
+    put16le(out, 0);
+    put16le(out, 0);
+    put16le(out, width);
+    put16le(out, height);
+    out.push_back(0);
+    out.push_back(MIN_CODE_SIZE);
+
+    std::vector<uint8_t> codes;
+    BitWriter bits(codes);
+    std::vector<int16_t> child(MAX_CODES << MIN_CODE_SIZE, -1);
+    int size = MIN_CODE_SIZE + 1;
+    int next = END + 1;
+    bits.put(CLEAR, size);
+    size_t count = pixels.size();
+    int prefix = count ? pixels[0] : 0;
+    for (size_t i = 1; i < count; ++i) {
+        int c = pixels[i];
+        int code = child[(prefix << MIN_CODE_SIZE) | c];
+        if (code >= 0) {
+            prefix = code;
+            continue;
+        }
+        bits.put(prefix, size);
+        int entry = next++;
+        child[(prefix << MIN_CODE_SIZE) | c] = static_cast<int16_t>(entry);
+        if (entry >= (1 << size)) size++;
+        if (entry == MAX_CODES - 1) { // Table pleine : on repart de zéro
+            bits.put(CLEAR, size);
+            std::fill(child.begin(), child.end(), -1);
+            size = MIN_CODE_SIZE + 1;
+            next = END + 1;
+        }
+        prefix = c;
+    }
+    bits.put(prefix, size);
+    // Le décodeur ajoute encore une entrée en lisant le dernier code
+    if (next == (1 << size) && size < 12) size++;
+    bits.put(END, size);
+    bits.flush();
+
+    for (size_t i = 0; i < codes.size(); i += 255) {
+        size_t block = std::min<size_t>(255, codes.size() - i);
+        out.push_back(static_cast<uint8_t>(block));
+        out.insert(out.end(), codes.begin() + i, codes.begin() + i + block);
+    }
+    out.push_back(0);
+    return out;
+}
+
+}
+
+int FrameView::pixelWidth() const {
+    return std::max(1, static_cast<int>(std::ceil(width * zoom)));
+}
+
+int FrameView::pixelHeight() const {
+    return std::max(1, static_cast<int>(std::ceil(height * zoom)));
+}
+
+void rasterizeFrame(const Grid& grid, const FrameView& view, std::vector<uint8_t>& pixels,
+                    std::vector<Cell>& cells) {
+    int w = view.pixelWidth(), h = view.pixelHeight();
+    pixels.assign(static_cast<size_t>(w) * h, 0);
+
+    // Chaque cellule couvre au moins un pixel, même en vue très dézoomée
+    auto plot = [&](const Cell& cell, uint8_t color) {
+        int x0 = static_cast<int>((cell.x - view.x) * view.zoom);
+        int y0 = static_cast<int>((cell.y - view.y) * view.zoom);
+        int x1 = std::max(x0 + 1, static_cast<int>((cell.x - view.x + 1) * view.zoom));
+        int y1 = std::max(y0 + 1, static_cast<int>((cell.y - view.y + 1) * view.zoom));
+        for (int y = std::max(0, y0); y < std::min(h, y1); ++y) {
+            std::fill(pixels.begin() + static_cast<size_t>(y) * w + std::max(0, x0),
+                      pixels.begin() + static_cast<size_t>(y) * w + std::min(w, x1), color);
+        }
+    };
+
+    int64_t x1 = view.x + view.width - 1, y1 = view.y + view.height - 1;
+    cells.clear();
+    grid.getCellsInRect(view.x, view.y, x1, y1, cells);
+    for (const auto& cell : cells) plot(cell, 1);
+    for (const auto& cell : grid.getGodCells()) {
+        if (cell.x >= view.x && cell.x <= x1 && cell.y >= view.y && cell.y <= y1) plot(cell, 2);
+    }
+}
+
+FrameExporter::FrameExporter(const std::string& path, int width, int height, int delay_ms, unsigned thread_count)
+    : path(path), width(width), height(height), delay_ms(std::clamp(delay_ms, 0, 65535)) {
+    if (hasExtension(path, ".gif")) format = Format::GIF;
+    else if (hasExtension(path, ".apng")) format = Format::APNG;
+    else format = Format::PNG_SEQUENCE;
+
+    std::vector<uint8_t> header;
+    if (format == Format::GIF) {
+        header = { 'G', 'I', 'F', '8', '9', 'a' };
+        put16le(header, width);
+        put16le(header, height);
+        header.insert(header.end(), { 0x91, 0, 0 }); // Palette globale de 4 couleurs
+        header.insert(header.end(), &FRAME_PALETTE[0][0], &FRAME_PALETTE[0][0] + sizeof(FRAME_PALETTE));
+        header.insert(header.end(), { 0, 0, 0 });
+        const char loop[] = "\x21\xFF\x0BNETSCAPE2.0\x03\x01\x00\x00\x00"; // Boucle infinie
+        header.insert(header.end(), loop, loop + sizeof(loop) - 1);
+    } else if (format == Format::APNG) {
+        std::vector<uint8_t> actl = actlData(0);
+        pngHeader(header, width, height, &actl);
+        actl_offset = sizeof(PNG_SIGNATURE) + 12 + 13; // Après IHDR
+    }
+    if (format != Format::PNG_SEQUENCE) {
+        out.open(path, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(header.data()), header.size());
+    }
+
+    if (thread_count == 0) thread_count = std::max(1u, std::thread::hardware_concurrency());
+    max_queued = 2 * thread_count + 2;
+    for (unsigned i = 0; i < thread_count; ++i) workers.emplace_back(&FrameExporter::run, this);
+}
+
+FrameExporter::~FrameExporter() {
+    if (!finished) finish();
+}
+
+bool FrameExporter::good() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return !failed && (format == Format::PNG_SEQUENCE || static_cast<bool>(out));
+}
+
+void FrameExporter::addFrame(std::vector<uint8_t> pixels) {
+    std::unique_lock<std::mutex> lock(mutex);
+    space.wait(lock, [this]() { return submitted - written < max_queued; });
+    pending.push_back(Frame{submitted++, std::move(pixels)});
+    wake.notify_one();
+}
+
+bool FrameExporter::finish() {
+    if (finished) return !failed;
+    finished = true;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto& worker : workers) worker.join();
+    workers.clear();
+
+    if (format == Format::GIF) {
+        out.put(0x3B);
+    } else if (format == Format::APNG) {
+        std::vector<uint8_t> end;
+        pngChunk(end, "IEND", {});
+        out.write(reinterpret_cast<const char*>(end.data()), end.size());
+        // Le nombre d'images n'est connu qu'ici : on réécrit acTL
+        std::vector<uint8_t> actl;
+        pngChunk(actl, "acTL", actlData(static_cast<uint32_t>(written)));
+        out.seekp(actl_offset);
+        out.write(reinterpret_cast<const char*>(actl.data()), actl.size());
+    }
+    if (out.is_open()) {
+        out.close();
+        if (out.fail()) failed = true;
+    }
+    return !failed;
+}
+
+void FrameExporter::run() {
+    for (;;) {
+        Frame frame;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this]() { return stopping || !pending.empty(); });
+            if (pending.empty()) return;
+            frame = std::move(pending.front());
+            pending.pop_front();
+        }
+        std::vector<uint8_t> data = encode(frame);
+
+        // Les images sont écrites dans l'ordre, par le thread qui complète la suite
+        std::lock_guard<std::mutex> lock(mutex);
+        encoded[frame.index] = std::move(data);
+        while (!encoded.empty() && encoded.begin()->first == written) {
+            if (!failed && !writeFrame(written, encoded.begin()->second)) failed = true;
+            encoded.erase(encoded.begin());
+            written++;
+        }
+        space.notify_all();
+    }
+}
+
+std::vector<uint8_t> FrameExporter::encode(const Frame& frame) const {
+    TRACE_ZONE("encode frame");
+    if (format == Format::GIF) return gifFrame(frame.pixels, width, height, delay_ms);
+    std::vector<uint8_t> data = pngImageData(frame.pixels, width, height);
+    if (format == Format::APNG) return data;
+
+    std::vector<uint8_t> png;
+    pngHeader(png, width, height, nullptr);
+    pngChunk(png, "IDAT", data);
+    pngChunk(png, "IEND", {});
+    return png;
+}
+
+bool FrameExporter::writeFrame(uint64_t index, const std::vector<uint8_t>& data) {
+    if (format == Format::PNG_SEQUENCE) {
+        std::string base = hasExtension(path, ".png") ? path.substr(0, path.size() - 4) : path;
+        char suffix[32];
+        std::snprintf(suffix, sizeof(suffix), "_%06llu.png", static_cast<unsigned long long>(index));
+        std::ofstream file(base + suffix, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(data.data()), data.size());
+        return static_cast<bool>(file);
+    }
+    if (format == Format::GIF) {
+        out.write(reinterpret_cast<const char*>(data.data()), data.size());
+        return static_cast<bool>(out);
+    }
+
+    // APNG : fcTL puis IDAT pour la première image (image par défaut), fdAT ensuite
+    std::vector<uint8_t> chunks, fctl;
+    put32be(fctl, sequence++);
+    put32be(fctl, width);
+    put32be(fctl, height);
+    put32be(fctl, 0);
+    put32be(fctl, 0);
+    fctl.insert(fctl.end(), { static_cast<uint8_t>(delay_ms >> 8), static_cast<uint8_t>(delay_ms), 0x03, 0xE8 });
+    fctl.insert(fctl.end(), { 0, 0 }); // Pas d'effacement, remplacement
+    pngChunk(chunks, "fcTL", fctl);
+    if (index == 0) {
+        pngChunk(chunks, "IDAT", data);
+    } else {
+        std::vector<uint8_t> fdat;
+        put32be(fdat, sequence++);
+        fdat.insert(fdat.end(), data.begin(), data.end());
+        pngChunk(chunks, "fdAT", fdat);
+    }
+    out.write(reinterpret_cast<const char*>(chunks.data()), chunks.size());
+    return static_cast<bool>(out);
+}
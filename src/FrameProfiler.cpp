@@ -0,0 +1,101 @@
+#include "FrameProfiler.hpp"
+
+#include <SDL2/SDL.h>
+#include <algorithm>
+
+namespace {
+
+double elapsedMs(uint64_t start, uint64_t end) {
+    return static_cast<double>(end - start) * 1000.0 / static_cast<double>(SDL_GetPerformanceFrequency());
+}
+
+}
+
+FrameProfiler::FrameProfiler() : current(0), frameStart(SDL_GetPerformanceCounter()) {
+    std::fill(&times[0][0], &times[0][0] + FRAME_HISTORY * PHASE_COUNT, 0.0);
+    std::fill(frameTimes, frameTimes + FRAME_HISTORY, 0.0);
+    std::fill(generations, generations + FRAME_HISTORY, 0);
+    std::fill(cells, cells + FRAME_HISTORY, 0);
+}
+
+void FrameProfiler::beginFrame() {
+    uint64_t now = SDL_GetPerformanceCounter();
+    frameTimes[current] = elapsedMs(frameStart, now);
+    frameStart = now;
+    current = (current + 1) % FRAME_HISTORY;
+    std::fill(times[current], times[current] + PHASE_COUNT, 0.0);
+    frameTimes[current] = 0.0;
+    generations[current] = 0;
+    cells[current] = 0;
+}
+
+void FrameProfiler::addTime(FramePhase phase, double ms) {
+    times[current][static_cast<int>(phase)] += ms;
+}
+
+void FrameProfiler::addWork(uint64_t generation_count, uint64_t cell_count) {
+    generations[current] += generation_count;
+    cells[current] += cell_count;
+}
+
+double FrameProfiler::phaseTime(FramePhase phase, int age) const {
+    return times[(current - age % FRAME_HISTORY + FRAME_HISTORY) % FRAME_HISTORY][static_cast<int>(phase)];
+}
+
+// Moyennes sur les images terminées (l'image en cours est incomplète)
+double FrameProfiler::averageTime(FramePhase phase) const {
+    double total = 0;
+    for (int age = 1; age < FRAME_HISTORY; ++age) total += phaseTime(phase, age);
+    return total / (FRAME_HISTORY - 1);
+}
+
+double FrameProfiler::averageFrameTime() const {
+    double total = 0;
+    for (int i = 0; i < FRAME_HISTORY; ++i) {
+        if (i != current) total += frameTimes[i];
+    }
+    return total / (FRAME_HISTORY - 1);
+}
+
+double FrameProfiler::generationsPerSecond() const {
+    double ms = averageFrameTime() * (FRAME_HISTORY - 1);
+    uint64_t total = 0;
+    for (int i = 0; i < FRAME_HISTORY; ++i) {
+        if (i != current) total += generations[i];
+    }
+    return ms > 0 ? total * 1000.0 / ms : 0.0;
+}
+
+double FrameProfiler::cellsPerSecond() const {
+    double ms = averageFrameTime() * (FRAME_HISTORY - 1);
+    uint64_t total = 0;
+    for (int i = 0; i < FRAME_HISTORY; ++i) {
+        if (i != current) total += cells[i];
+    }
+    return ms > 0 ? total * 1000.0 / ms : 0.0;
+}
+
+const char* FrameProfiler::phaseName(FramePhase phase) {
+    switch (phase) {
+        case FramePhase::EVENTS: return "Events";
+        case FramePhase::STEP: return "Step";
+        case FramePhase::HISTORY: return "History";
+        case FramePhase::RENDER_GRID: return "Grid";
+        case FramePhase::RENDER_UI: return "UI";
+        case FramePhase::PRESENT: return "Present";
+        default: return "";
+    }
+}
+
+ProfileScope::ProfileScope(FrameProfiler& profiler, FramePhase phase)
+    : profiler(profiler), phase(phase), start(SDL_GetPerformanceCounter()), outer(profiler.active) {
+    if (outer) profiler.addTime(outer->phase, elapsedMs(outer->start, start));
+    profiler.active = this;
+}
+
+ProfileScope::~ProfileScope() {
+    uint64_t end = SDL_GetPerformanceCounter();
+    profiler.addTime(phase, elapsedMs(start, end));
+    profiler.active = outer;
+    if (outer) outer->start = end; // La phase englobante reprend ici
+}
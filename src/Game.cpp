@@ -1,17 +1,31 @@
 #include "Game.hpp"
 #include <iostream>
 #include <fstream>
+#include <ctime>
+#include <cstdio>
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include "GridEngine.hpp"
+#include "PatternIO.hpp"
+#include "Trace.hpp"
+#include <unistd.h>
 
 Game::Game() : 
     WIDTH(1280), HEIGHT(720),
     window(nullptr), renderer(nullptr), font(nullptr),
     gameState(MAIN_MENU),
     camera_x(0.0f), camera_y(0.0f), zoom(1.0f), 
-    running(true), paused(true), simulation_speed_ms(200), generation_count(0), last_update_time(0),
+    running(true), paused(true), simulation_speed_ms(200), steps_per_update(1), generation_count(0), last_update_time(0),
+    random_seed(static_cast<uint64_t>(time(NULL))), saveScroll(0),
     history_index(-1), godModeActive(false),
     isPanning(false), panStartX(0), panStartY(0),
     isSelecting(false), isDrawing(false), selectionRect({0,0,0,0}) {
 
+    journal = std::make_unique<JournalWriter>("autosave.journal", 64, 8 << 20);
+    journalDirty = false;
+    hasAutosave = std::ifstream("autosave.journal").good();
+
     SDL_Init(SDL_INIT_VIDEO);
     TTF_Init();
     
@@ -19,6 +33,7 @@ Game::Game() :
         SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED,
         WIDTH, HEIGHT, SDL_WINDOW_SHOWN | SDL_WINDOW_RESIZABLE);
     renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED);
+    if (!renderer) renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_SOFTWARE); // Pilote "dummy" des relectures
 
     font = TTF_OpenFont("assets/font.ttf", 24);
     if (!font) {
@@ -29,7 +44,10 @@ Game::Game() :
     // Main Menu Buttons
     newGameButton = { WIDTH / 2 - 100, HEIGHT / 2 - 80, 200, 50 };
     loadGameButton = { WIDTH / 2 - 100, HEIGHT / 2 - 20, 200, 50 };
-    quitButton = { WIDTH / 2 - 100, HEIGHT / 2 + 40, 200, 50 };
+    importRleButton = { WIDTH / 2 - 100, HEIGHT / 2 + 40, 200, 50 };
+    resumeButton = { WIDTH / 2 - 100, HEIGHT / 2 + 100, 200, 50 };
+    browserBackButton = { 20, HEIGHT - 60, 200, 40 };
+    quitButton = { WIDTH / 2 - 100, HEIGHT / 2 + 160, 200, 50 };
 
     // In-Game UI Buttons
     playPauseButton = { WIDTH - UI_WIDTH + 20, 40, 210, 40 };
@@ -39,15 +57,25 @@ Game::Game() :
     clearButton = { WIDTH - UI_WIDTH + 20, 190, 210, 40 };
     randomizeButton = { WIDTH - UI_WIDTH + 20, 240, 210, 40 };
     godModeButton = { WIDTH - UI_WIDTH + 20, 290, 210, 40 };
-    saveButton = { WIDTH - UI_WIDTH + 20, 340, 210, 40 };
+    saveButton = { WIDTH - UI_WIDTH + 20, 340, 100, 40 };
+    exportRleButton = { WIDTH - UI_WIDTH + 130, 340, 100, 40 };
     randomizeSelectionButton = { WIDTH - UI_WIDTH + 20, 390, 210, 40 };
     backToMenuButton = { WIDTH - UI_WIDTH + 20, HEIGHT - 60, 210, 40 };
     slowDownButton = { WIDTH - UI_WIDTH + 20, 440, 100, 40 };
     speedUpButton = { WIDTH - UI_WIDTH + 130, 440, 100, 40 };
-    changeRulesButton = { WIDTH - UI_WIDTH + 20, 540, 210, 40 };
+    changeRulesButton = { WIDTH - UI_WIDTH + 20, 540, 100, 40 };
+    engineButton = { WIDTH - UI_WIDTH + 130, 540, 100, 40 };
+    recordButton = { WIDTH - UI_WIDTH + 20, 615, 210, 36 };
 }
 
 Game::~Game() {
+    if (saveThread.joinable()) saveThread.join();
+    if (!replayJournal.empty()) {
+        journal.reset(); // Termine les écritures en cours
+        std::remove(replayJournal.c_str());
+    }
+    if (metrics && !metrics->update(grid, generation_count, true)) std::cerr << "Failed to write metrics" << std::endl;
+    closeSaveBrowser();
     if (font) TTF_CloseFont(font);
     SDL_DestroyRenderer(renderer);
     SDL_DestroyWindow(window);
@@ -57,16 +85,121 @@ Game::~Game() {
 
 void Game::run() {
     while (running) {
-        handleEvents();
-        update();
-        render();
-        SDL_Delay(16);
+        if (inputReplay) {
+            if (!inputReplay->nextFrame(frameTicks, frameInput)) break;
+            replayCursor = 0;
+        } else {
+            frameTicks = SDL_GetTicks();
+            frameInput.clear();
+        }
+        auto frameStart = std::chrono::steady_clock::now();
+        profiler.beginFrame();
+        {
+            TRACE_ZONE("frame");
+            {
+                TRACE_ZONE("events");
+                ProfileScope scope(profiler, FramePhase::EVENTS);
+                handleEvents();
+            }
+            update();
+            render();
+        }
+        double frameMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frameStart).count();
+        if (inputRecorder && !inputRecorder->writeFrame(frameTicks, frameInput)) {
+            std::cerr << "Failed to write input log, recording stopped" << std::endl;
+            inputRecorder.reset();
+        }
+        if (metrics) {
+            uint64_t historyBytes = 0;
+            for (const auto& state : history) historyBytes += state->memoryUsage();
+            metrics->setHistoryBytes(historyBytes);
+            if (!metrics->update(grid, generation_count)) std::cerr << "Failed to write metrics" << std::endl;
+        }
+        if (inputReplay) {
+            replayFrameTimes.push_back(frameMs); // Relecture à pleine vitesse
+        } else {
+            SDL_Delay(16);
+        }
+    }
+    if (inputReplay) reportReplay();
+}
+
+bool Game::nextEvent(SDL_Event& event) {
+    if (inputReplay) {
+        if (replayCursor >= frameInput.size()) return false;
+        const InputEvent& input = frameInput[replayCursor++];
+        event = input.event;
+        inputMods = input.mods;
+        inputMouseX = input.mouse_x;
+        inputMouseY = input.mouse_y;
+        return true;
+    }
+    if (!SDL_PollEvent(&event)) return false;
+    inputMods = SDL_GetModState();
+    SDL_GetMouseState(&inputMouseX, &inputMouseY);
+    if (inputRecorder && isRecordedEvent(event)) {
+        frameInput.push_back({event, inputMods, inputMouseX, inputMouseY});
+    }
+    return true;
+}
+
+bool Game::recordInput(const std::string& path) {
+    inputRecorder = std::make_unique<InputRecorder>(path, random_seed, hasAutosave);
+    if (!inputRecorder->good()) inputRecorder.reset();
+    return inputRecorder != nullptr;
+}
+
+bool Game::replayInput(const std::string& path) {
+    inputReplay = std::make_unique<InputReplay>(path);
+    if (!inputReplay->good()) {
+        inputReplay.reset();
+        return false;
+    }
+    // Même point de départ qu'à l'enregistrement
+    random_seed = inputReplay->randomSeed();
+    hasAutosave = inputReplay->hasAutosave();
+    // Le journal de la relecture va dans un fichier temporaire :
+    // autosave.journal reste celui de la dernière vraie partie
+    replayJournal = (std::filesystem::temp_directory_path() /
+                     ("shinra_replay_" + std::to_string(getpid()) + ".journal")).string();
+    journal = std::make_unique<JournalWriter>(replayJournal, 64, 8 << 20);
+    return true;
+}
+
+bool Game::refuseFileRead(const char* action) const {
+    if (!inputRecorder && !inputReplay) return false;
+    std::cerr << action << " is disabled while input is recorded or replayed" << std::endl;
+    return true;
+}
+
+bool Game::refuseFileWrite(const char* action) const {
+    if (!inputReplay) return false;
+    std::cerr << action << " is disabled during an input replay" << std::endl;
+    return true;
+}
+
+void Game::reportReplay() const {
+    if (replayFrameTimes.empty()) {
+        std::cout << "Replay: no frames" << std::endl;
+        return;
     }
+    std::vector<double> sorted = replayFrameTimes;
+    std::sort(sorted.begin(), sorted.end());
+    double total = 0.0;
+    for (double ms : sorted) total += ms;
+    auto percentile = [&](double p) {
+        return sorted[std::min(sorted.size() - 1, static_cast<size_t>(p * sorted.size()))];
+    };
+    std::cout << "Replay: " << sorted.size() << " frames, " << generation_count << " generations, "
+              << total << "ms total" << std::endl
+              << "Frame time (ms): mean " << total / sorted.size()
+              << " p50 " << percentile(0.50) << " p90 " << percentile(0.90)
+              << " p99 " << percentile(0.99) << " max " << sorted.back() << std::endl;
 }
 
 void Game::handleEvents() {
     SDL_Event event;
-    while (SDL_PollEvent(&event)) {
+    while (nextEvent(event)) {
         if (event.type == SDL_QUIT) {
             running = false;
         }
@@ -83,16 +216,22 @@ void Game::handleEvents() {
             randomizeButton.x = WIDTH - UI_WIDTH + 20;
             godModeButton.x = WIDTH - UI_WIDTH + 20;
             saveButton.x = WIDTH - UI_WIDTH + 20;
+            exportRleButton.x = WIDTH - UI_WIDTH + 130;
             randomizeSelectionButton.x = WIDTH - UI_WIDTH + 20;
             backToMenuButton.x = WIDTH - UI_WIDTH + 20;
             slowDownButton.x = WIDTH - UI_WIDTH + 20;
             speedUpButton.x = WIDTH - UI_WIDTH + 130;
             changeRulesButton.x = WIDTH - UI_WIDTH + 20;
+            engineButton.x = WIDTH - UI_WIDTH + 130;
+            recordButton.x = WIDTH - UI_WIDTH + 20;
             backToMenuButton.y = HEIGHT - 60;
+            browserBackButton.y = HEIGHT - 60;
         }
 
         if (gameState == IN_GAME) {
             handleGameEvents(event);
+        } else if (gameState == SAVE_BROWSER) {
+            handleBrowserEvents(event);
         } else { // MAIN_MENU
             handleMenuEvents(event);
         }
@@ -107,8 +246,7 @@ void Game::handleGameEvents(SDL_Event& event) {
                 panStartX = event.button.x - camera_x;
                 panStartY = event.button.y - camera_y;
             } else if (event.button.button == SDL_BUTTON_LEFT) {
-                const Uint8* keyboardState = SDL_GetKeyboardState(NULL);
-                if (keyboardState[SDL_SCANCODE_LSHIFT] || keyboardState[SDL_SCANCODE_RSHIFT]) {
+                if (inputMods & KMOD_SHIFT) {
                     isDrawing = true;
                     // Activer la cellule sous le curseur immédiatement
                     handleGameMouseClick(event.button);
@@ -142,14 +280,21 @@ void Game::handleGameEvents(SDL_Event& event) {
                 selectionRect.w = event.motion.x - selectionRect.x;
                 selectionRect.h = event.motion.y - selectionRect.y;
             } else if (isDrawing) {
-                int grid_x = floor((event.motion.x - camera_x) / (CELL_SIZE * zoom));
-                int grid_y = floor((event.motion.y - camera_y) / (CELL_SIZE * zoom));
+                int64_t grid_x = floor((event.motion.x - camera_x) / (CELL_SIZE * zoom));
+                int64_t grid_y = floor((event.motion.y - camera_y) / (CELL_SIZE * zoom));
                 grid.setCell(grid_x, grid_y, true);
             }
             break;
         case SDL_MOUSEWHEEL:
             handleMouseWheel(event.wheel);
             break;
+        case SDL_KEYDOWN:
+            if (event.key.keysym.sym == SDLK_F3) showProfiler = !showProfiler;
+            else if (event.key.keysym.sym == SDLK_F9) dumpTrace();
+            else if (event.key.keysym.sym == SDLK_l) toggleStampMode();
+            else if (event.key.keysym.sym == SDLK_LEFTBRACKET) selectPattern(-1);
+            else if (event.key.keysym.sym == SDLK_RIGHTBRACKET) selectPattern(1);
+            break;
     }
 }
 
@@ -174,18 +319,27 @@ void Game::handleMenuMouseClick(SDL_MouseButtonEvent& b) {
             b.y >= newGameButton.y && b.y <= newGameButton.y + newGameButton.h) {
             gameState = IN_GAME;
             grid.clear();
-            history.clear();
-            history_index = -1;
             generation_count = 0;
-            addToHistory();
+            startSession();
         } else if (b.x >= loadGameButton.x && b.x <= loadGameButton.x + loadGameButton.w &&
                    b.y >= loadGameButton.y && b.y <= loadGameButton.y + loadGameButton.h) {
-            if (grid.loadFromFile("save.dat")) {
+            if (!refuseFileRead("Loading a save")) openSaveBrowser();
+        } else if (b.x >= importRleButton.x && b.x <= importRleButton.x + importRleButton.w &&
+                   b.y >= importRleButton.y && b.y <= importRleButton.y + importRleButton.h) {
+            if (!refuseFileRead("Importing pattern.rle") && grid.loadFromFile("pattern.rle")) {
                 gameState = IN_GAME;
-                history.clear();
-                history_index = -1;
-                generation_count = 0; // Ou charger depuis le fichier de sauvegarde si vous l'ajoutez
-                addToHistory();
+                generation_count = 0;
+                startSession();
+            }
+        } else if (hasAutosave && b.x >= resumeButton.x && b.x <= resumeButton.x + resumeButton.w &&
+                   b.y >= resumeButton.y && b.y <= resumeButton.y + resumeButton.h) {
+            GridSnapshot recovered;
+            uint64_t generation = 0;
+            if (!refuseFileRead("Resuming the autosave") && readJournal("autosave.journal", recovered, generation)) {
+                grid.restore(std::move(recovered));
+                gameState = IN_GAME;
+                generation_count = generation;
+                startSession();
             }
         } else if (b.x >= quitButton.x && b.x <= quitButton.x + quitButton.w &&
                    b.y >= quitButton.y && b.y <= quitButton.y + quitButton.h) {
@@ -205,11 +359,12 @@ void Game::handleGameMouseClick(SDL_MouseButtonEvent& b) {
         // UI click, ignore selection
         if (b.y >= playPauseButton.y && b.y <= playPauseButton.y + playPauseButton.h) {
             paused = !paused;
-            if (!paused) last_update_time = SDL_GetTicks();
+            if (!paused) last_update_time = frameTicks;
         } else if (b.y >= nextStepButton.y && b.y <= nextStepButton.y + nextStepButton.h) {
-            if (paused) {
-                grid.update(paused);
-                generation_count++;
+            if (paused && playback) {
+                advancePlayback(steps_per_update);
+            } else if (paused) {
+                stepSimulation(steps_per_update);
                 addToHistory();
             }
         } else if (b.y >= undoButton.y && b.y <= undoButton.y + undoButton.h) {
@@ -229,14 +384,17 @@ void Game::handleGameMouseClick(SDL_MouseButtonEvent& b) {
             int grid_w = (WIDTH - UI_WIDTH) / (CELL_SIZE * zoom);
             int grid_h = HEIGHT / (CELL_SIZE * zoom);
             generation_count = 0;
-            grid.randomize(grid_w, grid_h, -camera_x / (CELL_SIZE * zoom), -camera_y / (CELL_SIZE * zoom));
+            grid.randomize(grid_w, grid_h, -camera_x / (CELL_SIZE * zoom), -camera_y / (CELL_SIZE * zoom), random_seed++);
             addToHistory();
         } else if (b.x >= godModeButton.x && b.x <= godModeButton.x + godModeButton.w &&
                    b.y >= godModeButton.y && b.y <= godModeButton.y + godModeButton.h) {
             godModeActive = !godModeActive;
-        } else if (b.x >= saveButton.x && b.x <= saveButton.x + saveButton.w &&
-                   b.y >= saveButton.y && b.y <= saveButton.y + saveButton.h) {
-            grid.saveToFile("save.dat");
+        } else if (b.y >= saveButton.y && b.y <= saveButton.y + saveButton.h) {
+            if (b.x >= saveButton.x && b.x <= saveButton.x + saveButton.w) {
+                if (!refuseFileWrite("Saving")) startSave(newSaveSlotPath());
+            } else if (b.x >= exportRleButton.x && b.x <= exportRleButton.x + exportRleButton.w) {
+                if (!refuseFileWrite("Exporting pattern.rle")) startSave("pattern.rle");
+            }
         } else if (b.x >= randomizeSelectionButton.x && b.x <= randomizeSelectionButton.x + randomizeSelectionButton.w &&
                    b.y >= randomizeSelectionButton.y && b.y <= randomizeSelectionButton.y + randomizeSelectionButton.h) {
             if (wasSelection) {
@@ -252,35 +410,57 @@ void Game::handleGameMouseClick(SDL_MouseButtonEvent& b) {
                 }
 
                 // Convert screen coordinates to grid coordinates
-                int start_x = floor((normalizedRect.x - camera_x) / (CELL_SIZE * zoom));
-                int start_y = floor((normalizedRect.y - camera_y) / (CELL_SIZE * zoom));
-                int end_x = floor((normalizedRect.x + normalizedRect.w - camera_x) / (CELL_SIZE * zoom));
-                int end_y = floor((normalizedRect.y + normalizedRect.h - camera_y) / (CELL_SIZE * zoom));
+                int64_t start_x = floor((normalizedRect.x - camera_x) / (CELL_SIZE * zoom));
+                int64_t start_y = floor((normalizedRect.y - camera_y) / (CELL_SIZE * zoom));
+                int64_t end_x = floor((normalizedRect.x + normalizedRect.w - camera_x) / (CELL_SIZE * zoom));
+                int64_t end_y = floor((normalizedRect.y + normalizedRect.h - camera_y) / (CELL_SIZE * zoom));
                 
-                grid.randomize_selection(start_x, start_y, end_x - start_x + 1, end_y - start_y + 1);
+                grid.randomize_selection(start_x, start_y, end_x - start_x + 1, end_y - start_y + 1, random_seed++);
                 addToHistory();
             }
         } else if (b.x >= backToMenuButton.x && b.x <= backToMenuButton.x + backToMenuButton.w &&
                    b.y >= backToMenuButton.y && b.y <= backToMenuButton.y + backToMenuButton.h) {
+            recorder.reset();
+            playback.reset();
             gameState = MAIN_MENU;
+            hasAutosave = true;
         } else if (b.y >= slowDownButton.y && b.y <= slowDownButton.y + slowDownButton.h) {
+            // Sous 0 ms, la vitesse se règle en générations par mise à jour
             if (b.x >= slowDownButton.x && b.x <= slowDownButton.x + slowDownButton.w) {
-                simulation_speed_ms += 50;
+                if (steps_per_update > 1) steps_per_update /= 2;
+                else simulation_speed_ms += 50;
             } else if (b.x >= speedUpButton.x && b.x <= speedUpButton.x + speedUpButton.w) {
                 if (simulation_speed_ms >= 50) simulation_speed_ms -= 50;
+                else if (steps_per_update < 1024) steps_per_update *= 2;
             }
         } else if (b.x >= changeRulesButton.x && b.x <= changeRulesButton.x + changeRulesButton.w &&
                    b.y >= changeRulesButton.y && b.y <= changeRulesButton.y + changeRulesButton.h) {
             RuleSet current_rules = grid.getRuleSet(); // Assurez-vous que Grid a getRuleSet()
             int next_rules_int = (static_cast<int>(current_rules) + 1) % static_cast<int>(RuleSet::COUNT);
             grid.setRuleSet(static_cast<RuleSet>(next_rules_int));
+            journalDirty = true; // La règle fait partie de l'état journalisé
+        } else if (b.x >= engineButton.x && b.x <= engineButton.x + engineButton.w &&
+                   b.y >= engineButton.y && b.y <= engineButton.y + engineButton.h) {
+            // Auto, puis chaque moteur imposé tour à tour ; la grille passe telle quelle
+            int next_engine = grid.isAutoEngine() ? 0 : static_cast<int>(grid.getEngine()) + 1;
+            if (next_engine < static_cast<int>(EngineKind::COUNT)) grid.setEngine(static_cast<EngineKind>(next_engine));
+            else grid.setAutoEngine(true);
+        } else if (b.x >= recordButton.x && b.x <= recordButton.x + recordButton.w &&
+                   b.y >= recordButton.y && b.y <= recordButton.y + recordButton.h) {
+            toggleRecording();
         }
     } else if (!wasSelection) {
         // Grid click (not a selection drag or drawing)
-        int grid_x = floor((b.x - camera_x) / (CELL_SIZE * zoom));
-        int grid_y = floor((b.y - camera_y) / (CELL_SIZE * zoom));
-        if (godModeActive) {
+        int64_t grid_x = floor((b.x - camera_x) / (CELL_SIZE * zoom));
+        int64_t grid_y = floor((b.y - camera_y) / (CELL_SIZE * zoom));
+        if (stampMode) {
+            // Le motif entier est fusionné d'un coup, coin haut-gauche sous le curseur
+            patternLibrary.patternCells(stampIndex, grid_x, grid_y, stampCells);
+            grid.stampCells(std::move(stampCells));
+            addToHistory();
+        } else if (godModeActive) {
             grid.setGodCell(grid_x, grid_y, !grid.isGod(grid_x, grid_y));
+            journalDirty = true; // Hors historique, mais journalisé
         } else {
             grid.setCell(grid_x, grid_y, !grid.isAlive(grid_x, grid_y));
             addToHistory();
@@ -299,33 +479,129 @@ void Game::handleMouseWheel(SDL_MouseWheelEvent& wheel) {
     } else if (wheel.y < 0) {
         zoom /= 1.1f;
     }
-    int mouse_x, mouse_y;
-    SDL_GetMouseState(&mouse_x, &mouse_y);
-    camera_x = mouse_x - (mouse_x - camera_x) * (zoom / old_zoom);
-    camera_y = mouse_y - (mouse_y - camera_y) * (zoom / old_zoom);
+    camera_x = inputMouseX - (inputMouseX - camera_x) * (zoom / old_zoom);
+    camera_y = inputMouseY - (inputMouseY - camera_y) * (zoom / old_zoom);
 }
 
 void Game::update() {
-    Uint32 current_time = SDL_GetTicks();
+    Uint32 current_time = frameTicks;
     if (!paused && current_time > last_update_time + simulation_speed_ms) {
-        grid.update(paused);
-        generation_count++;
-        addToHistory();
+        if (playback) {
+            advancePlayback(steps_per_update);
+        } else {
+            stepSimulation(steps_per_update);
+            addToHistory();
+        }
         last_update_time = current_time;
     }
+
+    // Le journal prend le dernier état dès que son thread est libre : sous
+    // charge, des générations sont sautées mais la simulation ne ralentit pas.
+    if (journalDirty && journal->ready()) {
+        journal->submit(generation_count, grid.snapshot());
+        journalDirty = false;
+    }
+}
+
+void Game::stepSimulation(uint64_t n) {
+    TRACE_ZONE("stepSimulation");
+    ProfileScope scope(profiler, FramePhase::STEP);
+    profiler.addWork(n, grid.population() * n);
+    auto start = std::chrono::steady_clock::now();
+    if (!recorder) {
+        grid.step(n);
+        generation_count += n;
+    } else {
+        for (uint64_t i = 0; i < n; ++i) {
+            grid.step(1);
+            recorder->append(++generation_count, grid);
+        }
+    }
+    if (metrics) {
+        metrics->observeStep(n, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    }
+}
+
+void Game::toggleRecording() {
+    if (playback) {
+        stopPlayback();
+    } else if (recorder) {
+        if (!recorder->finish()) std::cerr << "Failed to finish recording" << std::endl;
+        recorder.reset();
+    } else if (!refuseFileWrite("Recording")) {
+        recorder = std::make_unique<RecordingWriter>(newSaveSlotPath("run_", ".rec"));
+        // La première frame est l'état courant
+        if (!recorder->good() || !recorder->append(generation_count, grid)) {
+            std::cerr << "Failed to start recording" << std::endl;
+            recorder.reset();
+        }
+    }
+}
+
+void Game::advancePlayback(uint64_t frames) {
+    TRACE_ZONE("advancePlayback");
+    ProfileScope scope(profiler, FramePhase::STEP);
+    if (playback->seek(playback->frame() + frames)) {
+        GridSnapshot frame;
+        playback->snapshot(frame);
+        grid.restore(std::move(frame));
+        generation_count = playback->generation();
+    }
+    if (playback->frame() + 1 >= playback->frameCount()) paused = true; // Fin de l'enregistrement
+}
+
+void Game::stopPlayback() {
+    playback.reset();
+    startSession();
+}
+
+void Game::toggleStampMode() {
+    if (!stampMode && refuseFileRead("The pattern library")) return;
+    if (!libraryScanned) {
+        libraryScanned = true;
+        size_t parsed = patternLibrary.scan();
+        std::cout << "Pattern library: " << patternLibrary.patterns().size() << " patterns, "
+                  << parsed << " parsed" << std::endl;
+    }
+    stampMode = !stampMode;
+    if (stampMode && (stampIndex >= patternLibrary.patterns().size() || !patternLibrary.patterns()[stampIndex].valid)) {
+        selectPattern(1);
+    }
+}
+
+void Game::selectPattern(int direction) {
+    const auto& patterns = patternLibrary.patterns();
+    if (!stampMode) return;
+    size_t count = patterns.size();
+    for (size_t tries = 0; tries < count; ++tries) {
+        stampIndex = (stampIndex + count + direction) % count;
+        if (patterns[stampIndex].valid) return;
+    }
+    stampMode = false; // Aucun motif lisible
 }
 
 void Game::render() {
+    TRACE_ZONE("render");
     SDL_SetRenderDrawColor(renderer, 20, 20, 30, 255);
     SDL_RenderClear(renderer);
 
     if (gameState == IN_GAME) {
-        renderGrid();
+        {
+            TRACE_ZONE("renderGrid");
+            ProfileScope scope(profiler, FramePhase::RENDER_GRID);
+            renderGrid();
+        }
+        TRACE_ZONE("renderUI");
+        ProfileScope scope(profiler, FramePhase::RENDER_UI);
         renderUI();
+    } else if (gameState == SAVE_BROWSER) {
+        renderSaveBrowser();
     } else { // MAIN_MENU
         renderMainMenu();
     }
 
+    TRACE_ZONE("present");
+    ProfileScope scope(profiler, FramePhase::PRESENT);
     SDL_RenderPresent(renderer);
 }
 
@@ -359,16 +635,16 @@ void Game::renderGrid() {
 
     // Draw living cells
     SDL_SetRenderDrawColor(renderer, 100, 255, 100, 255);
-    for (const auto& cell : grid.getAliveCells()) {
-        if (cell.x >= grid_x_start && cell.x <= grid_x_end && cell.y >= grid_y_start && cell.y <= grid_y_end) {
-            SDL_Rect r = {
-                (int)round(cell.x * scaled_cell_size + camera_x),
-                (int)round(cell.y * scaled_cell_size + camera_y),
-                (int)round(scaled_cell_size),
-                (int)round(scaled_cell_size)
-            };
-            if (r.x < WIDTH - UI_WIDTH) SDL_RenderFillRect(renderer, &r);
-        }
+    visibleCells.clear();
+    grid.getCellsInRect(grid_x_start, grid_y_start, grid_x_end, grid_y_end, visibleCells);
+    for (const auto& cell : visibleCells) {
+        SDL_Rect r = {
+            (int)round(cell.x * scaled_cell_size + camera_x),
+            (int)round(cell.y * scaled_cell_size + camera_y),
+            (int)round(scaled_cell_size),
+            (int)round(scaled_cell_size)
+        };
+        if (r.x < WIDTH - UI_WIDTH) SDL_RenderFillRect(renderer, &r);
     }
 
     // Draw God Mode cells
@@ -407,10 +683,41 @@ void Game::renderUI() {
     std::string genText = "Generation: " + std::to_string(generation_count);
     renderText(genText.c_str(),  10, 10, 0, 0, textColor);
     
-    std::string popText = "Population: " + std::to_string(grid.getAliveCells().size());
+    std::string popText = "Population: " + std::to_string(grid.population());
     renderText(popText.c_str(), 10, 40, 0, 0, textColor);
 
+    if (saving) {
+        std::string saveText = "Saving... " + std::to_string(static_cast<int>(saveProgress * 100)) + "%";
+        renderText(saveText.c_str(), 10, 70, 0, 0, textColor);
+        SDL_Rect bar_bg = { 10, 100, 200, 8 };
+        SDL_Rect bar = { 10, 100, static_cast<int>(200 * saveProgress), 8 };
+        SDL_SetRenderDrawColor(renderer, 50, 50, 60, 255);
+        SDL_RenderFillRect(renderer, &bar_bg);
+        SDL_SetRenderDrawColor(renderer, 100, 255, 100, 255);
+        SDL_RenderFillRect(renderer, &bar);
+    }
+
+    if (playback) {
+        std::string frameText = "Frame: " + std::to_string(playback->frame() + 1) + " / " +
+                                std::to_string(playback->frameCount());
+        renderText(frameText.c_str(), 10, 115, 0, 0, textColor);
+    } else if (recorder) {
+        std::string recText = "REC " + std::to_string(recorder->frameCount()) + " frames";
+        renderText(recText.c_str(), 10, 115, 0, 0, { 255, 80, 80, 255 });
+    }
+
+    if (stampMode) {
+        const PatternEntry& pattern = patternLibrary.patterns()[stampIndex];
+        std::string stampText = "Stamp: " + pattern.name + " (" + std::to_string(pattern.population) + ")";
+        renderText(stampText.c_str(), 10, 145, 0, 0, textColor);
+    }
+
+    std::string engineText = std::string("Engine: ") + engineName(grid.getEngine());
+    if (grid.isAutoEngine()) engineText += " (auto)";
+    renderText(engineText.c_str(), 10, 175, 0, 0, textColor);
+
     std::string speedText = "Speed: " + std::to_string(simulation_speed_ms) + "ms";
+    if (steps_per_update > 1) speedText += " x" + std::to_string(steps_per_update);
     renderText(speedText.c_str(), WIDTH - UI_WIDTH + 20, 490, 0, 0, textColor);
 
     RuleSet current_rules = grid.getRuleSet();
@@ -460,6 +767,8 @@ void Game::renderUI() {
     SDL_SetRenderDrawColor(renderer, 80, 80, 180, 255);
     SDL_RenderFillRect(renderer, &saveButton);
     renderText("Save", saveButton.x, saveButton.y, saveButton.w, saveButton.h, textColor);
+    SDL_RenderFillRect(renderer, &exportRleButton);
+    renderText("RLE", exportRleButton.x, exportRleButton.y, exportRleButton.w, exportRleButton.h, textColor);
     SDL_RenderFillRect(renderer, &randomizeSelectionButton);
     renderText("Randomize Selection", randomizeSelectionButton.x, randomizeSelectionButton.y, randomizeSelectionButton.w, randomizeSelectionButton.h, textColor);
     SDL_RenderFillRect(renderer, &backToMenuButton);
@@ -474,7 +783,77 @@ void Game::renderUI() {
 
     SDL_SetRenderDrawColor(renderer, 80, 80, 180, 255);
     SDL_RenderFillRect(renderer, &changeRulesButton);
-    renderText("Change Rules", changeRulesButton.x, changeRulesButton.y, changeRulesButton.w, changeRulesButton.h, textColor);
+    renderText("Rules", changeRulesButton.x, changeRulesButton.y, changeRulesButton.w, changeRulesButton.h, textColor);
+    SDL_RenderFillRect(renderer, &engineButton);
+    renderText(grid.isAutoEngine() ? "Auto" : engineName(grid.getEngine()), engineButton.x, engineButton.y, engineButton.w, engineButton.h, textColor);
+
+    if (recorder) SDL_SetRenderDrawColor(renderer, 180, 80, 80, 255);
+    SDL_RenderFillRect(renderer, &recordButton);
+    const char* recordLabel = playback ? "Stop Playback" : recorder ? "Stop Rec" : "Record";
+    renderText(recordLabel, recordButton.x, recordButton.y, recordButton.w, recordButton.h, textColor);
+
+    if (showProfiler) renderProfiler();
+}
+
+void Game::renderProfiler() {
+    static const SDL_Color phaseColors[FrameProfiler::PHASE_COUNT] = {
+        { 230, 230, 90, 255 },  // Events
+        { 90, 200, 90, 255 },   // Step
+        { 200, 120, 60, 255 },  // History
+        { 80, 150, 230, 255 },  // Grid
+        { 190, 100, 220, 255 }, // UI
+        { 150, 150, 150, 255 }  // Present
+    };
+    // Sous la dernière ligne d'état de renderUI (moteur, y = 175)
+    const int x0 = 10, y0 = 215, graph_h = 100;
+    const double pixels_per_ms = 3.0; // 100 px = 33 ms, deux images à 60 Hz
+
+    SDL_Rect background = { x0 - 5, y0 - 5, 440, graph_h + 10 + 26 * 10 };
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 180);
+    SDL_RenderFillRect(renderer, &background);
+
+    // Une barre empilée par image, la plus récente à droite
+    for (int i = 0; i < FrameProfiler::FRAME_HISTORY - 1; ++i) {
+        int age = FrameProfiler::FRAME_HISTORY - 1 - i;
+        int top = y0 + graph_h;
+        for (int p = 0; p < FrameProfiler::PHASE_COUNT && top > y0; ++p) {
+            int h = static_cast<int>(profiler.phaseTime(static_cast<FramePhase>(p), age) * pixels_per_ms + 0.5);
+            h = std::min(h, top - y0);
+            if (h <= 0) continue;
+            top -= h;
+            SDL_Rect bar = { x0 + i * 3, top, 2, h };
+            SDL_SetRenderDrawColor(renderer, phaseColors[p].r, phaseColors[p].g, phaseColors[p].b, 255);
+            SDL_RenderFillRect(renderer, &bar);
+        }
+    }
+    SDL_SetRenderDrawColor(renderer, 255, 80, 80, 255); // Repère 16,7 ms
+    int budget_y = y0 + graph_h - static_cast<int>(16.7 * pixels_per_ms);
+    SDL_RenderDrawLine(renderer, x0, budget_y, x0 + FrameProfiler::FRAME_HISTORY * 3, budget_y);
+
+    SDL_Color textColor = { 255, 255, 255, 255 };
+    char line[128];
+    int y = y0 + graph_h + 8;
+    for (int p = 0; p < FrameProfiler::PHASE_COUNT; ++p, y += 26) {
+        SDL_Rect swatch = { x0, y + 6, 12, 12 };
+        SDL_SetRenderDrawColor(renderer, phaseColors[p].r, phaseColors[p].g, phaseColors[p].b, 255);
+        SDL_RenderFillRect(renderer, &swatch);
+        FramePhase phase = static_cast<FramePhase>(p);
+        snprintf(line, sizeof(line), "%s: %.2f ms", FrameProfiler::phaseName(phase), profiler.averageTime(phase));
+        renderText(line, x0 + 20, y, 0, 0, textColor);
+    }
+
+    size_t history_bytes = 0;
+    for (const auto& state : history) history_bytes += state->memoryUsage();
+    snprintf(line, sizeof(line), "Frame: %.2f ms  Gen/s: %.1f", profiler.averageFrameTime(), profiler.generationsPerSecond());
+    renderText(line, x0, y, 0, 0, textColor);
+    snprintf(line, sizeof(line), "Cells/s: %.3g", profiler.cellsPerSecond());
+    renderText(line, x0, y + 26, 0, 0, textColor);
+    snprintf(line, sizeof(line), "Population: %zu", grid.population());
+    renderText(line, x0, y + 52, 0, 0, textColor);
+    snprintf(line, sizeof(line), "Memory: grid %.1f MB, history %.1f MB",
+             grid.memoryUsage() / 1048576.0, history_bytes / 1048576.0);
+    renderText(line, x0, y + 78, 0, 0, textColor);
 }
 
 void Game::renderMainMenu() {
@@ -483,8 +862,12 @@ void Game::renderMainMenu() {
     newGameButton.y = HEIGHT / 2 - 80;
     loadGameButton.x = WIDTH / 2 - 100;
     loadGameButton.y = HEIGHT / 2 - 20;
+    importRleButton.x = WIDTH / 2 - 100;
+    importRleButton.y = HEIGHT / 2 + 40;
+    resumeButton.x = WIDTH / 2 - 100;
+    resumeButton.y = HEIGHT / 2 + 100;
     quitButton.x = WIDTH / 2 - 100;
-    quitButton.y = HEIGHT / 2 + 40;
+    quitButton.y = HEIGHT / 2 + 160;
 
     SDL_Color textColor = { 255, 255, 255, 255 };
     SDL_SetRenderDrawColor(renderer, 80, 80, 180, 255);
@@ -492,6 +875,12 @@ void Game::renderMainMenu() {
     renderText("New Game", newGameButton.x, newGameButton.y, newGameButton.w, newGameButton.h, textColor);
     SDL_RenderFillRect(renderer, &loadGameButton);
     renderText("Load Game", loadGameButton.x, loadGameButton.y, loadGameButton.w, loadGameButton.h, textColor);
+    SDL_RenderFillRect(renderer, &importRleButton);
+    renderText("Import RLE", importRleButton.x, importRleButton.y, importRleButton.w, importRleButton.h, textColor);
+    if (hasAutosave) {
+        SDL_RenderFillRect(renderer, &resumeButton);
+        renderText("Resume Autosave", resumeButton.x, resumeButton.y, resumeButton.w, resumeButton.h, textColor);
+    }
     SDL_RenderFillRect(renderer, &quitButton);
     renderText("Quit", quitButton.x, quitButton.y, quitButton.w, quitButton.h, textColor);
 }
@@ -521,11 +910,37 @@ void Game::renderText(const char* text, int x, int y, int w, int h, SDL_Color co
     SDL_DestroyTexture(texture);
 }
 
+void Game::startSave(const std::string& filename) {
+    if (saving) return; // Une sauvegarde à la fois
+    if (saveThread.joinable()) saveThread.join();
+
+    saving = true;
+    saveProgress = 0.0f;
+    GridSnapshot snapshot = grid.snapshot();
+    snapshot.generation = generation_count;
+    saveThread = std::thread([this, filename, snapshot = std::move(snapshot)]() {
+        if (!snapshot.saveToFile(filename, &saveProgress)) {
+            std::cerr << "Failed to save " << filename << std::endl;
+        }
+        saving = false;
+    });
+}
+
+void Game::startSession() {
+    history.clear();
+    history_index = -1;
+    journal->restart();
+    addToHistory();
+}
+
 void Game::addToHistory() {
+    TRACE_ZONE("addToHistory");
+    ProfileScope scope(profiler, FramePhase::HISTORY);
+    journalDirty = true;
     if (history_index < history.size() - 1) {
         history.erase(history.begin() + history_index + 1, history.end());
     }
-    history.push_back(grid.getAliveCells());
+    history.push_back(grid.shareCells()); // Tuiles partagées avec la grille (TILED)
     if (history.size() > 50) { // Limite l'historique pour ne pas saturer la mémoire
         history.erase(history.begin());
     }
@@ -535,13 +950,179 @@ void Game::addToHistory() {
 void Game::undo() {
     if (history_index > 0) {
         history_index--;
-        grid.setAliveCells(history[history_index]);
+        grid.setAliveCells(*history[history_index]);
+        journalDirty = true;
     }
 }
 
 void Game::redo() {
     if (history_index < history.size() - 1) {
         history_index++;
-        grid.setAliveCells(history[history_index]);
+        grid.setAliveCells(*history[history_index]);
+        journalDirty = true;
+    }
+}
+
+void Game::enableMetrics(const std::string& path, double interval_seconds) {
+    metrics = std::make_unique<MetricsFile>(path, interval_seconds);
+}
+
+void Game::dumpTrace() {
+    if (refuseFileWrite("Writing a trace")) return;
+    std::string path = newSaveSlotPath("trace_", ".json");
+    if (writeChromeTrace(path, TRACE_DUMP_SECONDS)) {
+        std::cout << "Trace written to " << path << std::endl;
+    } else {
+        std::cerr << "Failed to write trace " << path << std::endl;
+    }
+}
+
+std::string Game::newSaveSlotPath(const std::string& prefix, const std::string& extension) {
+    std::error_code error;
+    std::filesystem::create_directories("saves", error);
+
+    char stamp[32];
+    time_t now = time(NULL);
+    strftime(stamp, sizeof(stamp), "%Y%m%d_%H%M%S", localtime(&now));
+    std::string path = "saves/" + prefix + stamp + extension;
+    for (int suffix = 2; std::filesystem::exists(path, error); ++suffix) {
+        path = "saves/" + prefix + stamp + "_" + std::to_string(suffix) + extension;
+    }
+    return path;
+}
+
+void Game::openSaveBrowser() {
+    closeSaveBrowser();
+    // Simple listing du dossier : aucun fichier n'est ouvert ici
+    std::error_code error;
+    for (const auto& entry : std::filesystem::directory_iterator("saves", error)) {
+        if (hasExtension(entry.path().string(), ".dat") || hasExtension(entry.path().string(), ".rec")) {
+            saveSlots.push_back(SaveSlot{entry.path().string()});
+        }
+    }
+    // Les noms sont horodatés : la plus récente en premier
+    std::sort(saveSlots.begin(), saveSlots.end(), [](const SaveSlot& a, const SaveSlot& b) {
+        return a.path > b.path;
+    });
+    if (std::filesystem::exists("save.dat", error)) saveSlots.push_back(SaveSlot{"save.dat"});
+    saveScroll = 0;
+    gameState = SAVE_BROWSER;
+}
+
+void Game::closeSaveBrowser() {
+    for (auto& slot : saveSlots) {
+        if (slot.thumbnail) SDL_DestroyTexture(slot.thumbnail);
+    }
+    saveSlots.clear();
+}
+
+void Game::handleBrowserEvents(SDL_Event& event) {
+    int visible_rows = std::max(1, (HEIGHT - 140) / SAVE_ROW_HEIGHT);
+    if (event.type == SDL_MOUSEWHEEL) {
+        int max_scroll = std::max(0, static_cast<int>(saveSlots.size()) - visible_rows);
+        saveScroll = std::clamp(saveScroll - event.wheel.y, 0, max_scroll);
+    } else if (event.type == SDL_MOUSEBUTTONDOWN && event.button.button == SDL_BUTTON_LEFT) {
+        const SDL_MouseButtonEvent& b = event.button;
+        if (b.x >= browserBackButton.x && b.x <= browserBackButton.x + browserBackButton.w &&
+            b.y >= browserBackButton.y && b.y <= browserBackButton.y + browserBackButton.h) {
+            closeSaveBrowser();
+            gameState = MAIN_MENU;
+            return;
+        }
+        int row = (b.y - 60) / SAVE_ROW_HEIGHT;
+        size_t index = saveScroll + row;
+        if (b.y < 60 || row >= visible_rows || index >= saveSlots.size()) return;
+
+        if (hasExtension(saveSlots[index].path, ".rec")) {
+            // Relecture : la grille suit l'enregistrement au lieu d'être simulée
+            auto reader = std::make_unique<RecordingReader>();
+            GridSnapshot frame;
+            if (!reader->open(saveSlots[index].path) || !reader->seek(0)) return;
+            reader->snapshot(frame);
+            grid.restore(std::move(frame));
+            closeSaveBrowser();
+            gameState = IN_GAME;
+            generation_count = reader->generation();
+            paused = true;
+            startSession();
+            playback = std::move(reader);
+            return;
+        }
+
+        uint64_t generation = 0;
+        if (grid.loadFromFile(saveSlots[index].path, &generation)) {
+            closeSaveBrowser();
+            gameState = IN_GAME;
+            generation_count = generation;
+            startSession();
+        }
+    }
+}
+
+void Game::renderSaveBrowser() {
+    SDL_Color textColor = { 255, 255, 255, 255 };
+    SDL_Color dimColor = { 180, 180, 190, 255 };
+    renderText("Load Game", 20, 15, 0, 0, textColor);
+    if (saveSlots.empty()) {
+        renderText("No saves in saves/", 20, 70, 0, 0, dimColor);
+    }
+
+    int visible_rows = std::max(1, (HEIGHT - 140) / SAVE_ROW_HEIGHT);
+    for (int row = 0; row < visible_rows && saveScroll + row < static_cast<int>(saveSlots.size()); ++row) {
+        SaveSlot& slot = saveSlots[saveScroll + row];
+        int y = 60 + row * SAVE_ROW_HEIGHT;
+
+        // Lecture paresseuse de l'en-tête et de l'aperçu, une fois par entrée
+        if (!slot.infoLoaded) {
+            slot.infoLoaded = true;
+            if (hasExtension(slot.path, ".rec")) {
+                RecordingReader reader; // Ne lit que l'en-tête et l'index
+                slot.valid = reader.open(slot.path);
+                slot.frames = reader.frameCount();
+            } else {
+                slot.valid = readSaveInfo(slot.path, slot.info);
+            }
+            if (slot.valid && slot.info.has_thumbnail) {
+                Uint32 pixels[SAVE_THUMBNAIL_SIZE * SAVE_THUMBNAIL_SIZE];
+                for (int i = 0; i < SAVE_THUMBNAIL_SIZE * SAVE_THUMBNAIL_SIZE; ++i) {
+                    Uint32 v = slot.info.thumbnail[i];
+                    pixels[i] = 0xFF000000 | ((v * 100 / 255) << 16) | (v << 8) | (v * 100 / 255);
+                }
+                slot.thumbnail = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STATIC,
+                                                   SAVE_THUMBNAIL_SIZE, SAVE_THUMBNAIL_SIZE);
+                if (slot.thumbnail) SDL_UpdateTexture(slot.thumbnail, NULL, pixels, SAVE_THUMBNAIL_SIZE * sizeof(Uint32));
+            }
+        }
+
+        SDL_Rect rowRect = { 20, y, WIDTH - 40, SAVE_ROW_HEIGHT - 8 };
+        SDL_SetRenderDrawColor(renderer, 50, 50, 60, 255);
+        SDL_RenderFillRect(renderer, &rowRect);
+        SDL_Rect thumbRect = { 24, y + 4, SAVE_THUMBNAIL_SIZE, SAVE_THUMBNAIL_SIZE };
+        SDL_SetRenderDrawColor(renderer, 20, 20, 30, 255);
+        SDL_RenderFillRect(renderer, &thumbRect);
+        if (slot.thumbnail) SDL_RenderCopy(renderer, slot.thumbnail, NULL, &thumbRect);
+
+        renderText(slot.path.c_str(), 100, y + 6, 0, 0, textColor);
+        std::string details;
+        if (!slot.valid) {
+            details = "Unreadable save";
+        } else if (hasExtension(slot.path, ".rec")) {
+            details = "Recording - " + std::to_string(slot.frames) + " frames";
+        } else if (slot.info.version == 0) {
+            details = "Old format - Population: " + std::to_string(slot.info.population);
+        } else {
+            details = "Gen " + std::to_string(slot.info.generation) +
+                      "  Pop " + std::to_string(slot.info.population) +
+                      "  " + (slot.info.rule == RuleSet::HIGHLIFE ? "HighLife" : "Conway");
+            if (slot.info.population > 0) {
+                details += "  " + std::to_string(slot.info.max_x - slot.info.min_x + 1) + "x" +
+                           std::to_string(slot.info.max_y - slot.info.min_y + 1);
+            }
+        }
+        renderText(details.c_str(), 100, y + 38, 0, 0, dimColor);
     }
-}
\ No newline at end of file
+
+    SDL_SetRenderDrawColor(renderer, 80, 80, 180, 255);
+    SDL_RenderFillRect(renderer, &browserBackButton);
+    renderText("Back", browserBackButton.x, browserBackButton.y, browserBackButton.w, browserBackButton.h, textColor);
+}
@@ -1,24 +1,143 @@
-#include <map>
 #include "Grid.hpp"
+#include "EngineSelector.hpp"
+#include "GridEngine.hpp"
+#include "PatternIO.hpp"
+#include "SaveFile.hpp"
+#include "Tile.hpp"
+#include "TileStore.hpp"
+#include "Trace.hpp"
 
-#include <set>
-#include <cstdlib>
-#include <ctime>  
-#include <fstream> 
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+#include <thread>
 
-void Grid::setCell(int x, int y, bool alive) {
-    if (alive) {
-        aliveCells.insert({x, y});
-    } else {
-        aliveCells.erase({x, y});
+namespace {
+
+uint64_t splitmix64(uint64_t& state) {
+    uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// xoshiro256** : rapide, et une graine distincte par flux (seed, stream)
+struct Xoshiro256 {
+    uint64_t s[4];
+
+    Xoshiro256(uint64_t seed, uint64_t stream) {
+        uint64_t state = seed ^ (stream * 0xD1B54A32D192ED03ULL);
+        for (auto& word : s) word = splitmix64(state);
+    }
+
+    static uint64_t rotl(uint64_t x, int k) {
+        return (x << k) | (x >> (64 - k));
+    }
+
+    uint64_t next() {
+        uint64_t result = rotl(s[1] * 5, 7) * 9;
+        uint64_t t = s[1] << 17;
+        s[2] ^= s[0];
+        s[3] ^= s[1];
+        s[1] ^= s[2];
+        s[0] ^= s[3];
+        s[2] ^= t;
+        s[3] = rotl(s[3], 45);
+        return result;
+    }
+};
+
+// Mot de 64 cellules dont chaque bit vaut 1 avec une probabilité threshold/256 :
+// on combine des mots uniformes par ET/OU en suivant les bits de threshold.
+uint64_t randomWord(Xoshiro256& rng, unsigned threshold) {
+    if (threshold == 0) return 0;
+    if (threshold >= 256) return ~0ULL;
+    uint64_t word = 0;
+    for (int bit = __builtin_ctz(threshold); bit < 8; ++bit) {
+        uint64_t r = rng.next();
+        word = ((threshold >> bit) & 1) ? (word | r) : (word & r);
+    }
+    return word;
+}
+
+}
+
+Grid::Grid() : engine(makeEngine(EngineKind::SPARSE)), selector(std::make_unique<EngineSelector>()) {}
+
+Grid::~Grid() = default;
+
+void Grid::setEngine(EngineKind kind) {
+    selector.reset();
+    migrate(kind);
+}
+
+void Grid::setAutoEngine(bool enabled) {
+    if (!enabled) selector.reset();
+    else if (!selector) selector = std::make_unique<EngineSelector>();
+}
+
+bool Grid::isAutoEngine() const {
+    return selector != nullptr;
+}
+
+void Grid::selectEngine() {
+    TRACE_ZONE("Grid::selectEngine");
+    PatternStats stats;
+    EngineKind from = engine->kind();
+    EngineKind to = selector->choose(*engine, stats);
+    if (to == from) return;
+    std::cout << "Engine: " << engineName(from) << " -> " << engineName(to) << " after " << stats.generation
+              << " generations (population " << stats.population << ", tiles " << stats.tiles
+              << ", density " << stats.density << ", fill " << stats.fill << ", activity " << stats.activity
+              << ", period " << stats.period << ")" << std::endl;
+    migrate(to);
+}
+
+void Grid::migrate(EngineKind kind) {
+    if (kind == engine->kind()) return;
+    std::vector<Cell> cells;
+    engine->save(cells);
+    std::unique_ptr<GridEngine> next = makeEngine(kind);
+    next->load(std::move(cells));
+    engine = std::move(next);
+    engine->setBudget(tileBudget, tileStore);
+    cacheValid = false;
+    cellCache = std::vector<Cell>();
+}
+
+bool Grid::setTileBudget(size_t bytes, const std::string& directory) {
+    std::shared_ptr<TileStore> store;
+    if (bytes) {
+        store = TileStore::create(directory);
+        if (!store) {
+            std::cerr << "Cannot create tile swap file in " << directory << std::endl;
+            return false;
+        }
     }
+    tileBudget = bytes;
+    tileStore = std::move(store);
+    engine->setBudget(tileBudget, tileStore);
+    return true;
+}
+
+size_t Grid::evictedTiles() const {
+    return engine->evictedTiles();
 }
 
-bool Grid::isAlive(int x, int y) const {
-    return aliveCells.find({x, y}) != aliveCells.end();
+EngineKind Grid::getEngine() const {
+    return engine->kind();
 }
 
-int Grid::countNeighbors(int x, int y) const {
+void Grid::setCell(int64_t x, int64_t y, bool alive) {
+    engine->setCell(x, y, alive);
+    cacheValid = false;
+}
+
+bool Grid::isAlive(int64_t x, int64_t y) const {
+    return engine->isAlive(x, y);
+}
+
+int Grid::countNeighbors(int64_t x, int64_t y) const {
     int count = 0;
     for (int dx = -1; dx <= 1; dx++) {
         for (int dy = -1; dy <= 1; dy++) {
@@ -30,50 +149,115 @@ int Grid::countNeighbors(int x, int y) const {
 }
 
 void Grid::clear() {
-    aliveCells.clear();
+    engine->clear();
+    cacheValid = false;
+    if (selector) selector->reset();
+}
+
+void Grid::mergeCells(std::vector<Cell>& cells) {
+    engine->addCells(cells);
+    cacheValid = false;
 }
 
-void Grid::randomize(int width, int height, int x_offset, int y_offset) {
+void Grid::randomize(int width, int height, int64_t x_offset, int64_t y_offset, uint64_t seed, double density) {
     clear();
-    srand(time(NULL));
-    for (int y = 0; y < height; ++y) {
-        for (int x = 0; x < width; ++x) {
-            if (rand() % 5 == 0) { 
-                aliveCells.insert({x + x_offset, y + y_offset});
-            }
-        }
-    }
+    fillRandom(x_offset, y_offset, width, height, seed, density);
 }
 
-void Grid::randomize_selection(int start_x, int start_y, int width, int height) {
-    srand(time(NULL));
-    for (int y = 0; y < height; ++y) {
-        for (int x = 0; x < width; ++x) {
-            if (rand() % 2 == 0) { 
-                setCell(start_x + x, start_y + y, true);
+void Grid::randomize_selection(int64_t start_x, int64_t start_y, int width, int height, uint64_t seed, double density) {
+    fillRandom(start_x, start_y, width, height, seed, density);
+}
+
+void Grid::fillRandom(int64_t start_x, int64_t start_y, int width, int height, uint64_t seed, double density) {
+    if (width <= 0 || height <= 0) return;
+    unsigned threshold = static_cast<unsigned>(std::clamp(density, 0.0, 1.0) * 256.0 + 0.5);
+    int words_per_column = (height + 63) / 64;
+
+    // Chaque thread remplit une bande de colonnes. La graine d'une colonne ne
+    // dépend que de (seed, x) : le résultat ne dépend pas du nombre de threads.
+    // Le moteur remet ensuite le lot dans l'ordre (mergeCells).
+    int thread_count = std::max(1u, std::thread::hardware_concurrency());
+    thread_count = std::min(thread_count, std::max(1, width * words_per_column / 1024));
+    std::vector<std::vector<Cell>> bands(thread_count);
+    std::vector<std::thread> workers;
+    for (int t = 0; t < thread_count; ++t) {
+        workers.emplace_back([&, t]() {
+            TRACE_ZONE("fillRandom band");
+            int x_begin = static_cast<int>(static_cast<int64_t>(width) * t / thread_count);
+            int x_end = static_cast<int>(static_cast<int64_t>(width) * (t + 1) / thread_count);
+            std::vector<Cell>& band = bands[t];
+            band.reserve(static_cast<size_t>(x_end - x_begin) * height * threshold / 256 + 64);
+            for (int x = x_begin; x < x_end; ++x) {
+                Xoshiro256 rng(seed, static_cast<uint64_t>(x));
+                for (int w = 0; w < words_per_column; ++w) {
+                    uint64_t bits = randomWord(rng, threshold);
+                    int remaining = height - w * 64;
+                    if (remaining < 64) bits &= (1ULL << remaining) - 1;
+                    while (bits) {
+                        int y = w * 64 + __builtin_ctzll(bits);
+                        band.push_back({start_x + x, start_y + y});
+                        bits &= bits - 1;
+                    }
+                }
             }
-        }
+        });
     }
+    for (auto& worker : workers) worker.join();
+
+    TRACE_ZONE("fillRandom merge");
+    std::vector<Cell> batch;
+    size_t total = 0;
+    for (const auto& band : bands) total += band.size();
+    batch.reserve(total);
+    for (const auto& band : bands) batch.insert(batch.end(), band.begin(), band.end());
+    mergeCells(batch);
 }
 
-void Grid::setGodCell(int x, int y, bool isGod) {
-    if (isGod) {
-        godCells.insert({x, y});
-    } else {
-        godCells.erase({x, y});
+void Grid::setGodCell(int64_t x, int64_t y, bool isGod) {
+    Cell cell = {x, y};
+    auto it = std::lower_bound(godCells.begin(), godCells.end(), cell);
+    bool present = it != godCells.end() && *it == cell;
+    if (isGod && !present) {
+        godCells.insert(it, cell);
+    } else if (!isGod && present) {
+        godCells.erase(it);
     }
 }
 
-bool Grid::isGod(int x, int y) const {
-    return godCells.count({x, y}) > 0;
+bool Grid::isGod(int64_t x, int64_t y) const {
+    return std::binary_search(godCells.begin(), godCells.end(), Cell{x, y});
 }
 
-const std::set<Cell>& Grid::getGodCells() const {
+const std::vector<Cell>& Grid::getGodCells() const {
     return godCells;
 }
 
-void Grid::setAliveCells(const std::set<Cell>& cells) {
-    aliveCells = cells;
+void Grid::setAliveCells(const std::vector<Cell>& cells) {
+    engine->load(cells);
+    cacheValid = false;
+    if (selector) selector->reset();
+}
+
+std::shared_ptr<const GridEngine> Grid::shareCells() const {
+    TRACE_ZONE("Grid::shareCells");
+    return engine->clone();
+}
+
+void Grid::setAliveCells(const GridEngine& cells) {
+    if (cells.kind() == engine->kind()) {
+        engine = cells.clone();
+        engine->setBudget(tileBudget, tileStore);
+    } else {
+        std::vector<Cell> sorted;
+        cells.save(sorted);
+        engine->load(std::move(sorted));
+    }
+    cacheValid = false;
+    if (selector) selector->reset();
+}
+
+void Grid::stampCells(std::vector<Cell> cells) {
+    mergeCells(cells);
 }
 
 void Grid::setRuleSet(RuleSet rules) {
@@ -85,97 +269,160 @@ RuleSet Grid::getRuleSet() const {
 }
 
 void Grid::update(bool& simPaused) {
+    (void)simPaused;
+    advance();
+}
 
-    std::set<Cell> cellsToCheck;
-    for (const auto& cell : aliveCells) {
-        for (int dx = -1; dx <= 1; dx++) {
-            for (int dy = -1; dy <= 1; dy++) {
-                cellsToCheck.insert({cell.x + dx, cell.y + dy});
-            }
-        }
+void Grid::step(uint64_t n) {
+    TRACE_ZONE("Grid::step");
+    for (uint64_t i = 0; i < n; ++i) {
+        // Grille figée (vide ou stable) : les générations restantes sont identiques
+        if (!advance()) break;
     }
+}
 
-    std::set<Cell> newAliveCells;
-    for (const auto& cell : cellsToCheck) {
-        if (isGod(cell.x, cell.y)) {
-            if (isAlive(cell.x, cell.y)) {
-                newAliveCells.insert(cell);
-            }
-            continue;
-        }
+bool Grid::advance() {
+    TRACE_ZONE("Grid::advance");
+    size_t before = engine->population();
+    uint64_t born = 0;
+    bool changed = engine->step(currentRuleSet, godCells, born);
+    cacheValid = false;
 
-        int neighbors = countNeighbors(cell.x, cell.y);
-        bool currentlyAlive = isAlive(cell.x, cell.y);
-        bool becomesAlive = false;
+    // Les morts se déduisent de la variation de population
+    uint64_t died = before + born - engine->population();
+    births += born;
+    deaths += died;
+    if (selector && selector->observe(engine->population(), born, died)) selectEngine();
+    return changed;
+}
 
-        switch (currentRuleSet) {
-            case RuleSet::CONWAY: 
-                if (!currentlyAlive && neighbors == 3) {
-                    becomesAlive = true; 
-                } else if (currentlyAlive && (neighbors == 2 || neighbors == 3)) {
-                    becomesAlive = true; 
-                }
-                break;
-            case RuleSet::HIGHLIFE: 
-                if (!currentlyAlive && (neighbors == 3 || neighbors == 6)) {
-                    becomesAlive = true; 
-                } else if (currentlyAlive && (neighbors == 2 || neighbors == 3)) {
-                    becomesAlive = true; 
-                }
-                break;
-            case RuleSet::COUNT:
-                break;
-        }
-        if (becomesAlive) newAliveCells.insert(cell);
+bool Grid::bounds(int64_t& min_x, int64_t& min_y, int64_t& max_x, int64_t& max_y) const {
+    return engine->bounds(min_x, min_y, max_x, max_y);
+}
+
+const std::vector<Cell>& Grid::getAliveCells() const {
+    if (const std::vector<Cell>* cells = engine->sortedCells()) return *cells;
+    if (!cacheValid) {
+        engine->save(cellCache);
+        cacheValid = true;
     }
-    aliveCells = newAliveCells;
+    return cellCache;
+}
+
+size_t Grid::population() const {
+    return engine->population();
 }
 
-const std::set<Cell>& Grid::getAliveCells() const {
-    return aliveCells;
+size_t Grid::memoryUsage() const {
+    return engine->memoryUsage() + (godCells.capacity() + cellCache.capacity()) * sizeof(Cell);
 }
 
-bool Grid::saveToFile(const std::string& filename) {
-    std::ofstream ofs(filename, std::ios::binary);
-    if (!ofs) return false;
+size_t Grid::tileCount() const {
+    return engine->tileCount();
+}
 
-    size_t alive_count = aliveCells.size();
-    ofs.write(reinterpret_cast<const char*>(&alive_count), sizeof(alive_count));
-    for (const auto& cell : aliveCells) {
-        ofs.write(reinterpret_cast<const char*>(&cell), sizeof(cell));
-    }
+uint64_t Grid::totalBirths() const {
+    return births;
+}
 
-    size_t god_count = godCells.size();
-    ofs.write(reinterpret_cast<const char*>(&god_count), sizeof(god_count));
-    for (const auto& cell : godCells) {
-        ofs.write(reinterpret_cast<const char*>(&cell), sizeof(cell));
-    }
+uint64_t Grid::totalDeaths() const {
+    return deaths;
+}
 
+void Grid::getCellsInRect(int64_t x0, int64_t y0, int64_t x1, int64_t y1, std::vector<Cell>& out) const {
+    engine->getCellsInRect(x0, y0, x1, y1, out);
+}
+
+// Écrit dans filename.tmp, le pousse sur le disque puis renomme : un fichier
+// existant n'est jamais laissé à moitié écrit, même si le processus ou la
+// machine s'arrête en cours de route. Les cellules vivantes viennent du
+// moteur alive s'il est donné, sinon de la liste aliveCells ; la sauvegarde
+// binaire prend directement les tuiles du moteur.
+static bool writeCells(const std::string& filename, const GridEngine* alive, const std::vector<Cell>& aliveCells,
+                       const std::vector<Cell>& god, RuleSet rules, uint64_t generation,
+                       bool compress, std::atomic<float>* progress) {
+    std::string tmp = filename + ".tmp";
+    bool written;
+    if (hasExtension(filename, ".rle") || hasExtension(filename, ".mc")) {
+        std::vector<Cell> scratch;
+        const std::vector<Cell>* cells = &aliveCells;
+        if (alive && !(cells = alive->sortedCells())) {
+            alive->save(scratch);
+            cells = &scratch;
+        }
+        if (hasExtension(filename, ".rle")) written = writeRLE(tmp, *cells, rules, progress);
+        else written = writeMacrocell(tmp, *cells, rules, progress);
+    } else {
+        std::vector<Tile> aliveTiles, godTiles;
+        if (alive) alive->saveTiles(aliveTiles);
+        else cellsToTiles(aliveCells, aliveTiles);
+        cellsToTiles(god, godTiles);
+        written = writeSaveFile(tmp, aliveTiles, godTiles, rules, generation, compress, progress);
+    }
+    if (!written || !syncFile(tmp) || std::rename(tmp.c_str(), filename.c_str()) != 0) {
+        std::remove(tmp.c_str());
+        return false;
+    }
     return true;
 }
 
-bool Grid::loadFromFile(const std::string& filename) {
-    std::ifstream ifs(filename, std::ios::binary);
-    if (!ifs) return false;
+bool Grid::saveToFile(const std::string& filename, uint64_t generation, bool compress) {
+    return writeCells(filename, engine.get(), {}, godCells, currentRuleSet, generation, compress, nullptr);
+}
 
-    aliveCells.clear();
-    godCells.clear();
+GridSnapshot Grid::snapshot() const {
+    GridSnapshot result;
+    result.frozen = shareCells();
+    result.godCells = godCells;
+    result.rules = currentRuleSet;
+    return result;
+}
 
-    size_t alive_count;
-    ifs.read(reinterpret_cast<char*>(&alive_count), sizeof(alive_count));
-    for (size_t i = 0; i < alive_count; ++i) {
-        Cell cell;
-        ifs.read(reinterpret_cast<char*>(&cell), sizeof(cell));
-        aliveCells.insert(cell);
+void Grid::restore(GridSnapshot snapshot) {
+    if (snapshot.frozen) {
+        setAliveCells(*snapshot.frozen);
+    } else {
+        engine->load(std::move(snapshot.aliveCells));
+        if (selector) selector->reset();
     }
+    godCells = std::move(snapshot.godCells);
+    currentRuleSet = snapshot.rules;
+    cacheValid = false;
+}
 
-    size_t god_count;
-    ifs.read(reinterpret_cast<char*>(&god_count), sizeof(god_count));
-    for (size_t i = 0; i < god_count; ++i) {
-        Cell cell;
-        ifs.read(reinterpret_cast<char*>(&cell), sizeof(cell));
-        godCells.insert(cell);
-    }
+const std::vector<Cell>& GridSnapshot::cells(std::vector<Cell>& scratch) const {
+    if (!frozen) return aliveCells;
+    if (const std::vector<Cell>* sorted = frozen->sortedCells()) return *sorted;
+    frozen->save(scratch);
+    return scratch;
+}
 
+void GridSnapshot::tiles(std::vector<Tile>& out) const {
+    if (frozen) frozen->saveTiles(out);
+    else cellsToTiles(aliveCells, out);
+}
+
+bool GridSnapshot::saveToFile(const std::string& filename, std::atomic<float>* progress) const {
+    return writeCells(filename, frozen.get(), aliveCells, godCells, rules, generation, true, progress);
+}
+
+bool Grid::loadFromFile(const std::string& filename, uint64_t* generation) {
+    TRACE_ZONE("Grid::loadFromFile");
+    std::vector<Cell> alive, god;
+    std::vector<Tile> tiles;
+    RuleSet rules = currentRuleSet;
+    bool loaded;
+    bool macrocell = hasExtension(filename, ".mc");
+    if (hasExtension(filename, ".rle")) loaded = readRLE(filename, alive, rules);
+    else if (macrocell) loaded = readMacrocell(filename, tiles, rules);
+    else loaded = readSaveFile(filename, alive, god, rules, generation);
+    if (!loaded) return false;
+    // Un macrocell arrive en tuiles : jamais développé en cellules pour TILED
+    if (macrocell) engine->loadTiles(std::move(tiles));
+    else engine->load(std::move(alive));
+    if (selector) selector->reset();
+    godCells = std::move(god);
+    currentRuleSet = rules;
+    cacheValid = false;
     return true;
 }
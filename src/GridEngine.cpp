@@ -0,0 +1,54 @@
+#include "GridEngine.hpp"
+#include "SetEngine.hpp"
+#include "SparseEngine.hpp"
+#include "TiledEngine.hpp"
+#include "Tile.hpp"
+
+namespace {
+
+const char* const ENGINE_NAMES[] = { "sparse", "tiled", "set" };
+
+}
+
+void GridEngine::saveTiles(std::vector<Tile>& out) const {
+    if (const std::vector<Cell>* cells = sortedCells()) {
+        cellsToTiles(*cells, out);
+        return;
+    }
+    std::vector<Cell> cells;
+    save(cells);
+    cellsToTiles(cells, out);
+}
+
+void GridEngine::loadTiles(std::vector<Tile> tiles) {
+    std::vector<Cell> cells;
+    for (const auto& tile : tiles) appendTileCells(tile.tx, tile.ty, tile.rows, cells);
+    tiles = std::vector<Tile>();
+    load(std::move(cells));
+}
+
+std::unique_ptr<GridEngine> makeEngine(EngineKind kind) {
+    switch (kind) {
+        case EngineKind::TILED:
+            return std::make_unique<TiledEngine>();
+        case EngineKind::SET:
+            return std::make_unique<SetEngine>();
+        default:
+            return std::make_unique<SparseEngine>();
+    }
+}
+
+const char* engineName(EngineKind kind) {
+    int index = static_cast<int>(kind);
+    return index >= 0 && index < static_cast<int>(EngineKind::COUNT) ? ENGINE_NAMES[index] : "unknown";
+}
+
+bool parseEngine(const std::string& name, EngineKind& kind) {
+    for (int i = 0; i < static_cast<int>(EngineKind::COUNT); ++i) {
+        if (name == ENGINE_NAMES[i]) {
+            kind = static_cast<EngineKind>(i);
+            return true;
+        }
+    }
+    return false;
+}
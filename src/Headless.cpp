@@ -0,0 +1,250 @@
+#include "Headless.hpp"
+#include "FrameExport.hpp"
+#include "Bench.hpp"
+#include "Check.hpp"
+#include "Grid.hpp"
+#include "GridEngine.hpp"
+#include "Metrics.hpp"
+#include "Recording.hpp"
+#include "Trace.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+void printUsage(std::ostream& out) {
+    out << "Usage: shinra_tensei [--metrics FILE] [--metrics-interval S]\n"
+           "                     [--record-input FILE] [--replay-input FILE]\n"
+           "       shinra_tensei --headless [--load FILE] [--random WxH] [--seed S]\n"
+           "                     [--density D] [--rules conway|highlife] [--steps N]\n"
+           "                     [--save FILE] [--uncompressed] [--record FILE.rec]\n"
+           "                     [--export FILE.gif|FILE.apng|FILE.png] [--view X,Y,WxH]\n"
+           "                     [--zoom Z] [--every N] [--delay MS] [--threads N]\n"
+           "                     [--trace FILE.json] [--metrics FILE.prom]\n"
+           "                     [--metrics-interval S] [--engine auto|sparse|tiled|set]\n"
+           "                     [--memory-budget MB] [--swap-dir DIR]\n"
+           "       shinra_tensei --headless --check [--seed S] [--steps N]\n"
+           "       shinra_tensei --headless --bench [--engine auto|sparse|tiled|set]" << std::endl;
+}
+
+bool isHeadless(int argc, char** argv) {
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--headless") == 0) return true;
+    }
+    return false;
+}
+
+int runHeadless(int argc, char** argv) {
+    Grid grid;
+    std::string loadFile, saveFile, recordFile, exportFile, traceFile, metricsFile;
+    int random_w = 0, random_h = 0;
+    uint64_t seed = 0;
+    double density = 0.2;
+    uint64_t steps = 0;
+    bool compress = true;
+    bool check = false;
+    bool bench = false;
+    FrameView view;
+    bool hasView = false;
+    uint64_t every = 1;
+    int delay_ms = 40;
+    unsigned threads = 0;
+    double metricsInterval = 10.0;
+    bool autoEngine = true;
+    EngineKind engine = EngineKind::SPARSE;
+    size_t budgetMB = 0;
+    std::string swapDir = ".";
+
+    int i = 1;
+    try {
+        for (; i < argc; ++i) {
+            std::string arg = argv[i];
+            bool hasValue = i + 1 < argc;
+            if (arg == "--headless") {
+                continue;
+            } else if (arg == "--load" && hasValue) {
+                loadFile = argv[++i];
+            } else if (arg == "--save" && hasValue) {
+                saveFile = argv[++i];
+            } else if (arg == "--random" && hasValue) {
+                if (std::sscanf(argv[++i], "%dx%d", &random_w, &random_h) != 2) {
+                    std::cerr << "Invalid --random size, expected WxH" << std::endl;
+                    return 1;
+                }
+            } else if (arg == "--seed" && hasValue) {
+                seed = std::stoull(argv[++i]);
+            } else if (arg == "--density" && hasValue) {
+                density = std::stod(argv[++i]);
+            } else if (arg == "--steps" && hasValue) {
+                steps = std::stoull(argv[++i]);
+            } else if (arg == "--record" && hasValue) {
+                recordFile = argv[++i];
+            } else if (arg == "--export" && hasValue) {
+                exportFile = argv[++i];
+            } else if (arg == "--view" && hasValue) {
+                long long x, y, w, h;
+                if (std::sscanf(argv[++i], "%lld,%lld,%lldx%lld", &x, &y, &w, &h) != 4 || w <= 0 || h <= 0) {
+                    std::cerr << "Invalid --view, expected X,Y,WxH" << std::endl;
+                    return 1;
+                }
+                view.x = x;
+                view.y = y;
+                view.width = w;
+                view.height = h;
+                hasView = true;
+            } else if (arg == "--zoom" && hasValue) {
+                view.zoom = std::stod(argv[++i]);
+            } else if (arg == "--every" && hasValue) {
+                every = std::max(1ULL, std::stoull(argv[++i]));
+            } else if (arg == "--delay" && hasValue) {
+                delay_ms = std::clamp(std::stoi(argv[++i]), 0, 65535);
+            } else if (arg == "--threads" && hasValue) {
+                threads = static_cast<unsigned>(std::stoul(argv[++i]));
+            } else if (arg == "--metrics" && hasValue) {
+                metricsFile = argv[++i];
+            } else if (arg == "--metrics-interval" && hasValue) {
+                metricsInterval = std::stod(argv[++i]);
+            } else if (arg == "--trace" && hasValue) {
+                traceFile = argv[++i];
+            } else if (arg == "--memory-budget" && hasValue) {
+                budgetMB = std::stoull(argv[++i]);
+                if (budgetMB > (SIZE_MAX >> 20)) throw std::out_of_range("--memory-budget");
+            } else if (arg == "--swap-dir" && hasValue) {
+                swapDir = argv[++i];
+            } else if (arg == "--bench") {
+                bench = true;
+            } else if (arg == "--check") {
+                check = true;
+            } else if (arg == "--uncompressed") {
+                compress = false;
+            } else if (arg == "--engine" && hasValue) {
+                std::string name = argv[++i];
+                autoEngine = name == "auto";
+                if (autoEngine) {
+                    grid.setAutoEngine(true);
+                } else if (parseEngine(name, engine)) {
+                    grid.setEngine(engine);
+                } else {
+                    std::cerr << "Unknown engine: " << name << std::endl;
+                    return 1;
+                }
+            } else if (arg == "--rules" && hasValue) {
+                std::string rules = argv[++i];
+                if (rules == "conway") grid.setRuleSet(RuleSet::CONWAY);
+                else if (rules == "highlife") grid.setRuleSet(RuleSet::HIGHLIFE);
+                else {
+                    std::cerr << "Unknown rules: " << rules << std::endl;
+                    return 1;
+                }
+            } else {
+                std::cerr << "Unknown option: " << arg << std::endl;
+                printUsage(std::cerr);
+                return 1;
+            }
+        }
+    } catch (const std::logic_error&) {
+        // std::stoull, std::stod... : valeur illisible ou hors limites
+        std::cerr << "Invalid value for " << argv[i - 1] << ": " << argv[i] << std::endl;
+        printUsage(std::cerr);
+        return 1;
+    }
+
+    if (bench) {
+        runBenchmarks(std::cout, autoEngine, engine);
+        return 0;
+    }
+    if (check) return runDifferentialCheck(seed, steps ? steps : 64, std::cout) == 0 ? 0 : 1;
+    if (budgetMB && !grid.setTileBudget(budgetMB << 20, swapDir)) return 1;
+
+    if (!loadFile.empty() && !grid.loadFromFile(loadFile)) {
+        std::cerr << "Failed to load " << loadFile << std::endl;
+        return 1;
+    }
+    if (random_w > 0 && random_h > 0) {
+        grid.randomize(random_w, random_h, -random_w / 2, -random_h / 2, seed, density);
+    }
+
+    // Vue par défaut : la boîte englobante de l'état initial
+    if (!exportFile.empty() && !hasView) {
+        int64_t min_x, min_y, max_x, max_y;
+        view.x = view.y = 0;
+        view.width = view.height = 64;
+        if (grid.bounds(min_x, min_y, max_x, max_y)) {
+            view.x = min_x;
+            view.y = min_y;
+            view.width = max_x - min_x + 1;
+            view.height = max_y - min_y + 1;
+        }
+    }
+    if (view.zoom <= 0 || static_cast<double>(view.pixelWidth()) * view.pixelHeight() > (1LL << 30)) {
+        std::cerr << "Export image too large, use --view or --zoom" << std::endl;
+        return 1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    if (recordFile.empty() && exportFile.empty() && metricsFile.empty()) {
+        grid.step(steps);
+    } else {
+        // Génération par génération : une frame enregistrée pour chacune, une
+        // image exportée toutes les `every`, état initial compris, et les
+        // métriques réécrites toutes les --metrics-interval secondes
+        std::unique_ptr<RecordingWriter> recorder;
+        std::unique_ptr<FrameExporter> exporter;
+        std::unique_ptr<MetricsFile> metrics;
+        if (!recordFile.empty()) recorder = std::make_unique<RecordingWriter>(recordFile);
+        if (!metricsFile.empty()) metrics = std::make_unique<MetricsFile>(metricsFile, metricsInterval);
+        if (!exportFile.empty()) {
+            exporter = std::make_unique<FrameExporter>(exportFile, view.pixelWidth(), view.pixelHeight(),
+                                                       delay_ms, threads);
+        }
+        std::vector<uint8_t> pixels;
+        std::vector<Cell> scratch;
+        for (uint64_t generation = 0; generation <= steps; ++generation) {
+            if (generation > 0) {
+                auto stepStart = std::chrono::steady_clock::now();
+                grid.step(1);
+                if (metrics) {
+                    metrics->observeStep(1, std::chrono::duration<double>(std::chrono::steady_clock::now() - stepStart).count());
+                }
+            }
+            if (metrics && !metrics->update(grid, generation, generation == steps)) {
+                std::cerr << "Failed to write metrics " << metricsFile << std::endl;
+                return 1;
+            }
+            if (recorder) recorder->append(generation, grid);
+            if (exporter && generation % every == 0) {
+                rasterizeFrame(grid, view, pixels, scratch);
+                exporter->addFrame(std::move(pixels));
+            }
+        }
+        if (recorder && !recorder->finish()) {
+            std::cerr << "Failed to write recording " << recordFile << std::endl;
+            return 1;
+        }
+        if (exporter && !exporter->finish()) {
+            std::cerr << "Failed to export " << exportFile << std::endl;
+            return 1;
+        }
+    }
+    double elapsed_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "Generation: " << steps
+              << " Population: " << grid.population()
+              << " Time: " << elapsed_ms << "ms" << std::endl;
+
+    if (!saveFile.empty() && !grid.saveToFile(saveFile, steps, compress)) {
+        std::cerr << "Failed to save " << saveFile << std::endl;
+        return 1;
+    }
+    if (!traceFile.empty() && !writeChromeTrace(traceFile)) {
+        std::cerr << "Failed to write trace " << traceFile << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,70 @@
+#include "InputLog.hpp"
+
+#include <cstring>
+
+bool isRecordedEvent(const SDL_Event& event) {
+    switch (event.type) {
+        case SDL_QUIT:
+        case SDL_WINDOWEVENT:
+        case SDL_KEYDOWN:
+        case SDL_KEYUP:
+        case SDL_MOUSEMOTION:
+        case SDL_MOUSEBUTTONDOWN:
+        case SDL_MOUSEBUTTONUP:
+        case SDL_MOUSEWHEEL:
+            return true;
+        default:
+            return false;
+    }
+}
+
+InputRecorder::InputRecorder(const std::string& path, uint64_t random_seed, bool has_autosave)
+    : out(path, std::ios::binary | std::ios::trunc) {
+    InputLogHeader header = {};
+    std::memcpy(header.magic, INPUT_LOG_MAGIC, sizeof(header.magic));
+    header.version = INPUT_LOG_VERSION;
+    header.has_autosave = has_autosave;
+    header.random_seed = random_seed;
+    header.event_size = sizeof(SDL_Event);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+}
+
+bool InputRecorder::good() const {
+    return static_cast<bool>(out);
+}
+
+bool InputRecorder::writeFrame(uint32_t ticks, const std::vector<InputEvent>& events) {
+    InputFrameHeader frame = { ticks, static_cast<uint32_t>(events.size()) };
+    out.write(reinterpret_cast<const char*>(&frame), sizeof(frame));
+    out.write(reinterpret_cast<const char*>(events.data()), events.size() * sizeof(InputEvent));
+    return static_cast<bool>(out);
+}
+
+InputReplay::InputReplay(const std::string& path) : in(path, std::ios::binary) {
+    valid = in.read(reinterpret_cast<char*>(&header), sizeof(header)) &&
+            std::memcmp(header.magic, INPUT_LOG_MAGIC, sizeof(header.magic)) == 0 &&
+            header.version == INPUT_LOG_VERSION && header.event_size == sizeof(SDL_Event);
+}
+
+bool InputReplay::good() const {
+    return valid;
+}
+
+uint64_t InputReplay::randomSeed() const {
+    return header.random_seed;
+}
+
+bool InputReplay::hasAutosave() const {
+    return header.has_autosave != 0;
+}
+
+bool InputReplay::nextFrame(uint32_t& ticks, std::vector<InputEvent>& events) {
+    InputFrameHeader frame;
+    if (!valid || !in.read(reinterpret_cast<char*>(&frame), sizeof(frame)) || frame.event_count > (1u << 20)) {
+        return false;
+    }
+    events.resize(frame.event_count);
+    if (!in.read(reinterpret_cast<char*>(events.data()), events.size() * sizeof(InputEvent))) return false;
+    ticks = frame.ticks;
+    return true;
+}
@@ -0,0 +1,223 @@
+#include "Journal.hpp"
+#include "Lz.hpp"
+#include "Trace.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+namespace {
+
+uint64_t fnv1a(const void* data, size_t size, uint64_t hash = 0xcbf29ce484222325ULL) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; ++i) hash = (hash ^ bytes[i]) * 0x100000001b3ULL;
+    return hash;
+}
+
+bool tileBefore(const Tile& a, const Tile& b) {
+    return Cell{a.tx, a.ty} < Cell{b.tx, b.ty};
+}
+
+bool sameTile(const Tile& a, const Tile& b) {
+    return a.tx == b.tx && a.ty == b.ty;
+}
+
+}
+
+void diffTiles(const std::vector<Tile>& previous, const std::vector<Tile>& next,
+               uint64_t layer, std::vector<JournalTile>& out) {
+    auto emit = [&](const Tile& tile, bool empty) {
+        JournalTile entry = { tile.tx, tile.ty, layer, {} };
+        if (!empty) std::memcpy(entry.rows, tile.rows, sizeof(entry.rows));
+        out.push_back(entry);
+    };
+    size_t p = 0, n = 0;
+    while (p < previous.size() || n < next.size()) {
+        if (n == next.size() || (p < previous.size() && tileBefore(previous[p], next[n]))) {
+            emit(previous[p++], true);
+        } else if (p == previous.size() || tileBefore(next[n], previous[p])) {
+            emit(next[n++], false);
+        } else {
+            if (std::memcmp(previous[p].rows, next[n].rows, sizeof(next[n].rows)) != 0) emit(next[n], false);
+            p++;
+            n++;
+        }
+    }
+}
+
+void applyTiles(std::vector<Tile>& tiles, const std::vector<JournalTile>& entries, uint64_t layer) {
+    std::vector<Tile> merged;
+    merged.reserve(tiles.size() + entries.size());
+    size_t t = 0;
+    for (const auto& entry : entries) {
+        if (entry.layer != layer) continue;
+        Tile tile = { entry.tx, entry.ty, {} };
+        std::memcpy(tile.rows, entry.rows, sizeof(tile.rows));
+        while (t < tiles.size() && tileBefore(tiles[t], tile)) merged.push_back(tiles[t++]);
+        if (t < tiles.size() && sameTile(tiles[t], tile)) t++;
+        bool empty = std::all_of(tile.rows, tile.rows + TILE_SIZE, [](uint64_t row) { return row == 0; });
+        if (!empty) merged.push_back(tile);
+    }
+    merged.insert(merged.end(), tiles.begin() + t, tiles.end());
+    tiles.swap(merged);
+}
+
+void tilesToCells(const std::vector<Tile>& tiles, std::vector<Cell>& cells) {
+    cells.clear();
+    for (const auto& tile : tiles) appendTileCells(tile.tx, tile.ty, tile.rows, cells);
+}
+
+uint64_t writeJournalRecord(std::ostream& out, JournalRecord type, uint64_t generation,
+                            RuleSet rule, const std::vector<JournalTile>& entries) {
+    JournalRecordHeader header = {};
+    header.magic = JOURNAL_MAGIC;
+    header.type = static_cast<uint32_t>(type);
+    header.generation = generation;
+    header.rule = static_cast<uint32_t>(rule);
+    header.tile_count = static_cast<uint32_t>(entries.size());
+    std::vector<uint8_t> payload;
+    lzCompress(reinterpret_cast<const uint8_t*>(entries.data()), entries.size() * sizeof(JournalTile), payload);
+    header.payload_size = payload.size();
+    header.checksum = fnv1a(payload.data(), payload.size());
+
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(payload.data()), payload.size());
+    return out ? sizeof(header) + payload.size() : 0;
+}
+
+bool readJournalRecord(std::istream& in, JournalRecordHeader& header, std::vector<JournalTile>& entries) {
+    if (!in.read(reinterpret_cast<char*>(&header), sizeof(header)) || header.magic != JOURNAL_MAGIC) return false;
+    size_t raw_size = static_cast<size_t>(header.tile_count) * sizeof(JournalTile);
+    if (header.payload_size > 2 * raw_size + 64) return false;
+    std::vector<uint8_t> payload(header.payload_size);
+    in.read(reinterpret_cast<char*>(payload.data()), payload.size());
+    if (!in || fnv1a(payload.data(), payload.size()) != header.checksum) return false;
+    entries.resize(header.tile_count);
+    return lzDecompress(payload.data(), payload.size(), reinterpret_cast<uint8_t*>(entries.data()), raw_size);
+}
+
+JournalWriter::JournalWriter(const std::string& path, uint64_t keyframe_interval, uint64_t bytes_per_second)
+    : path(path), keyframe_interval(keyframe_interval), bytes_per_second(bytes_per_second) {
+    worker = std::thread(&JournalWriter::run, this);
+}
+
+JournalWriter::~JournalWriter() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    worker.join();
+}
+
+bool JournalWriter::ready() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return !has_pending && !writing;
+}
+
+void JournalWriter::submit(uint64_t generation, GridSnapshot snapshot) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pending = std::move(snapshot);
+        pending_generation = generation;
+        has_pending = true;
+    }
+    wake.notify_one();
+}
+
+void JournalWriter::restart() {
+    std::lock_guard<std::mutex> lock(mutex);
+    restart_requested = true;
+}
+
+void JournalWriter::run() {
+    GridSnapshot snapshot;
+    for (;;) {
+        uint64_t generation;
+        bool keyframe;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this]() { return stopping || has_pending; });
+            if (!has_pending) return; // On écrit encore l'état en attente avant de s'arrêter
+            std::swap(snapshot, pending);
+            generation = pending_generation;
+            has_pending = false;
+            writing = true;
+            keyframe = restart_requested || records_since_keyframe >= keyframe_interval;
+            restart_requested = false;
+        }
+        write(generation, snapshot, keyframe);
+        std::lock_guard<std::mutex> lock(mutex);
+        writing = false;
+    }
+}
+
+void JournalWriter::write(uint64_t generation, const GridSnapshot& snapshot, bool keyframe) {
+    TRACE_ZONE("journal write");
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<Tile> next[2];
+    snapshot.tiles(next[0]);
+    cellsToTiles(snapshot.godCells, next[1]);
+
+    std::vector<JournalTile> entries;
+    for (uint64_t layer = 0; layer < 2; ++layer) {
+        diffTiles(keyframe ? std::vector<Tile>() : previous[layer], next[layer], layer, entries);
+    }
+    // Rien n'a changé depuis le dernier enregistrement
+    if (!keyframe && entries.empty() && snapshot.rules == previous_rule) return;
+
+    // Un keyframe remplace le journal : écrit à part puis renommé
+    std::string target = keyframe ? path + ".tmp" : path;
+    std::ofstream ofs(target, keyframe ? std::ios::binary | std::ios::trunc : std::ios::binary | std::ios::app);
+    uint64_t bytes = writeJournalRecord(ofs, keyframe ? JournalRecord::KEYFRAME : JournalRecord::DELTA,
+                                        generation, snapshot.rules, entries);
+    ofs.close();
+    if (!bytes || !ofs || (keyframe && std::rename(target.c_str(), path.c_str()) != 0)) {
+        std::cerr << "Failed to write autosave journal " << path << std::endl;
+        return;
+    }
+
+    previous[0].swap(next[0]);
+    previous[1].swap(next[1]);
+    previous_rule = snapshot.rules;
+    records_since_keyframe = keyframe ? 0 : records_since_keyframe + 1;
+
+    // Limite de débit : on dort le temps que l'écriture "aurait dû" prendre
+    if (bytes_per_second > 0) {
+        auto budget = std::chrono::duration<double>(static_cast<double>(bytes) / bytes_per_second);
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        if (elapsed < budget) std::this_thread::sleep_for(budget - elapsed);
+    }
+}
+
+bool readJournal(const std::string& path, GridSnapshot& snapshot, uint64_t& generation) {
+    std::ifstream ifs(path, std::ios::binary);
+    if (!ifs) return false;
+
+    std::vector<Tile> tiles[2];
+    std::vector<JournalTile> entries;
+    bool found_keyframe = false;
+    JournalRecordHeader header;
+    // Enregistrement tronqué ou corrompu : l'état précédent est le dernier sûr
+    while (readJournalRecord(ifs, header, entries)) {
+        bool keyframe = header.type == static_cast<uint32_t>(JournalRecord::KEYFRAME);
+        if (!found_keyframe && !keyframe) return false;
+
+        for (uint64_t layer = 0; layer < 2; ++layer) {
+            if (keyframe) tiles[layer].clear();
+            applyTiles(tiles[layer], entries, layer);
+        }
+        found_keyframe = true;
+        generation = header.generation;
+        if (header.rule < static_cast<uint32_t>(RuleSet::COUNT)) snapshot.rules = static_cast<RuleSet>(header.rule);
+    }
+    if (!found_keyframe) return false;
+
+    tilesToCells(tiles[0], snapshot.aliveCells);
+    tilesToCells(tiles[1], snapshot.godCells);
+    return true;
+}
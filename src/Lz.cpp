@@ -0,0 +1,103 @@
+#include "Lz.hpp"
+
+#include <cstring>
+
+namespace {
+
+const int HASH_BITS = 14;
+const size_t MIN_MATCH = 4;
+const size_t MAX_DISTANCE = 65535;
+
+uint32_t read32(const uint8_t* p) {
+    uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+uint32_t hash4(uint32_t v) {
+    return (v * 2654435761U) >> (32 - HASH_BITS);
+}
+
+void writeLength(std::vector<uint8_t>& out, size_t length) {
+    while (length >= 255) {
+        out.push_back(255);
+        length -= 255;
+    }
+    out.push_back(static_cast<uint8_t>(length));
+}
+
+void emitSequence(std::vector<uint8_t>& out, const uint8_t* literals, size_t literal_length,
+                  size_t distance, size_t match_length) {
+    size_t match_code = match_length ? match_length - MIN_MATCH : 0;
+    uint8_t token = static_cast<uint8_t>((literal_length < 15 ? literal_length : 15) << 4);
+    token |= static_cast<uint8_t>(match_code < 15 ? match_code : 15);
+    out.push_back(token);
+    if (literal_length >= 15) writeLength(out, literal_length - 15);
+    out.insert(out.end(), literals, literals + literal_length);
+    if (match_length == 0) return;
+    out.push_back(static_cast<uint8_t>(distance & 0xFF));
+    out.push_back(static_cast<uint8_t>(distance >> 8));
+    if (match_code >= 15) writeLength(out, match_code - 15);
+}
+
+bool readLength(const uint8_t*& in, const uint8_t* end, size_t& length) {
+    uint8_t byte;
+    do {
+        if (in == end) return false;
+        byte = *in++;
+        length += byte;
+    } while (byte == 255);
+    return true;
+}
+
+}
+
+void lzCompress(const uint8_t* src, size_t size, std::vector<uint8_t>& out) {
+    std::vector<uint32_t> table(1 << HASH_BITS, 0); // Position + 1, 0 = vide
+    size_t anchor = 0, pos = 0;
+    while (size >= MIN_MATCH && pos + MIN_MATCH <= size) {
+        uint32_t sequence = read32(src + pos);
+        uint32_t& slot = table[hash4(sequence)];
+        size_t candidate = slot;
+        slot = static_cast<uint32_t>(pos + 1);
+        if (candidate == 0 || pos - (candidate - 1) > MAX_DISTANCE || read32(src + candidate - 1) != sequence) {
+            pos++;
+            continue;
+        }
+        size_t match = candidate - 1;
+        size_t length = MIN_MATCH;
+        while (pos + length < size && src[match + length] == src[pos + length]) length++;
+
+        emitSequence(out, src + anchor, pos - anchor, pos - match, length);
+        pos += length;
+        anchor = pos;
+    }
+    emitSequence(out, src + anchor, size - anchor, 0, 0);
+}
+
+bool lzDecompress(const uint8_t* src, size_t size, uint8_t* dst, size_t raw_size) {
+    const uint8_t* in = src;
+    const uint8_t* end = src + size;
+    size_t out = 0;
+    while (in < end) {
+        uint8_t token = *in++;
+        size_t literal_length = token >> 4;
+        if (literal_length == 15 && !readLength(in, end, literal_length)) return false;
+        if (literal_length > static_cast<size_t>(end - in) || literal_length > raw_size - out) return false;
+        if (literal_length) std::memcpy(dst + out, in, literal_length);
+        in += literal_length;
+        out += literal_length;
+        if (in == end) break; // Dernière séquence : littéraux seuls
+
+        if (end - in < 2) return false;
+        size_t distance = in[0] | (in[1] << 8);
+        in += 2;
+        size_t match_length = token & 0x0F;
+        if (match_length == 15 && !readLength(in, end, match_length)) return false;
+        match_length += MIN_MATCH;
+        if (distance == 0 || distance > out || match_length > raw_size - out) return false;
+        // Copie octet par octet : la source peut chevaucher la destination
+        for (size_t i = 0; i < match_length; ++i, ++out) dst[out] = dst[out - distance];
+    }
+    return out == raw_size;
+}
@@ -0,0 +1,138 @@
+#include "Metrics.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <thread>
+#include <unistd.h>
+
+namespace {
+
+// Bornes hautes de l'histogramme, en secondes
+const double STEP_BOUNDS[MetricsFile::STEP_BUCKETS] = {
+    0.00001, 0.00005, 0.0001, 0.0005, 0.001, 0.005, 0.01, 0.05, 0.1, 0.5, 1.0, 5.0
+};
+
+struct ProcessStats {
+    uint64_t rss_bytes = 0;
+    double cpu_seconds = 0.0;
+    uint64_t threads = 0;
+};
+
+// Linux : /proc/self/stat (temps CPU, threads) et /proc/self/statm (RSS)
+ProcessStats readProcessStats() {
+    ProcessStats stats;
+    std::ifstream statm("/proc/self/statm");
+    uint64_t size, resident;
+    if (statm >> size >> resident) stats.rss_bytes = resident * static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+
+    std::ifstream stat("/proc/self/stat");
+    std::string line;
+    if (std::getline(stat, line)) {
+        // Le nom du programme (champ 2) peut contenir des espaces : on repart
+        // de la dernière parenthèse, suivie de l'état (champ 3)
+        size_t end = line.rfind(')');
+        if (end != std::string::npos) {
+            std::istringstream fields(line.substr(end + 1));
+            std::string field;
+            uint64_t utime = 0, stime = 0;
+            for (int index = 3; fields >> field && index <= 20; ++index) {
+                if (index == 14) utime = std::stoull(field);
+                else if (index == 15) stime = std::stoull(field);
+                else if (index == 20) stats.threads = std::stoull(field);
+            }
+            stats.cpu_seconds = static_cast<double>(utime + stime) / static_cast<double>(sysconf(_SC_CLK_TCK));
+        }
+    }
+    return stats;
+}
+
+void writeMetric(std::ostream& out, const char* name, const char* type, const char* help, double value) {
+    out << "# HELP " << name << ' ' << help << '\n'
+        << "# TYPE " << name << ' ' << type << '\n'
+        << name << ' ' << value << '\n';
+}
+
+}
+
+MetricsFile::MetricsFile(const std::string& path, double interval_seconds)
+    : path(path),
+      interval(std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+          std::chrono::duration<double>(interval_seconds))),
+      lastWrite(std::chrono::steady_clock::now()) {}
+
+void MetricsFile::observeStep(uint64_t generations, double seconds) {
+    if (generations == 0) return;
+    // Un pas de n générations compte pour n observations de sa durée moyenne
+    double perGeneration = seconds / static_cast<double>(generations);
+    int bucket = 0;
+    while (bucket < STEP_BUCKETS && perGeneration > STEP_BOUNDS[bucket]) bucket++;
+    stepCounts[bucket] += generations;
+    stepCount += generations;
+    stepSum += seconds;
+}
+
+void MetricsFile::setHistoryBytes(uint64_t bytes) {
+    historyBytes = bytes;
+}
+
+bool MetricsFile::update(const Grid& grid, uint64_t generation, bool force) {
+    auto now = std::chrono::steady_clock::now();
+    if (!force && written && now - lastWrite < interval) return true;
+    double elapsed = std::chrono::duration<double>(now - lastWrite).count();
+    lastWrite = now;
+
+    ProcessStats process = readProcessStats();
+    uint64_t births = grid.totalBirths(), deaths = grid.totalDeaths();
+    uint64_t generations = generation > lastGeneration ? generation - lastGeneration : 0;
+    double birthRate = generations ? static_cast<double>(births - lastBirths) / generations : 0.0;
+    double deathRate = generations ? static_cast<double>(deaths - lastDeaths) / generations : 0.0;
+    double cores = std::max(1u, std::thread::hardware_concurrency());
+    double utilization = elapsed > 0 ? (process.cpu_seconds - lastCpuSeconds) / (elapsed * cores) : 0.0;
+    lastGeneration = generation;
+    lastBirths = births;
+    lastDeaths = deaths;
+    lastCpuSeconds = process.cpu_seconds;
+    written = true;
+
+    std::ostringstream out;
+    out << std::setprecision(15); // Compteurs entiers écrits en entier
+    writeMetric(out, "shinra_generation", "gauge", "Current generation.", static_cast<double>(generation));
+    writeMetric(out, "shinra_population", "gauge", "Live cells.", static_cast<double>(grid.population()));
+    writeMetric(out, "shinra_tiles", "gauge", "Occupied 64x64 tiles.", static_cast<double>(grid.tileCount()));
+    writeMetric(out, "shinra_evicted_tiles", "gauge", "Tiles moved to the swap file.", static_cast<double>(grid.evictedTiles()));
+    writeMetric(out, "shinra_births_total", "counter", "Cells born since start.", static_cast<double>(births));
+    writeMetric(out, "shinra_deaths_total", "counter", "Cells died since start.", static_cast<double>(deaths));
+    writeMetric(out, "shinra_births_per_generation", "gauge", "Births per generation since the previous write.", birthRate);
+    writeMetric(out, "shinra_deaths_per_generation", "gauge", "Deaths per generation since the previous write.", deathRate);
+    writeMetric(out, "shinra_history_bytes", "gauge", "Memory held by the undo history.", static_cast<double>(historyBytes));
+    writeMetric(out, "shinra_grid_bytes", "gauge", "Memory reserved by the grid.", static_cast<double>(grid.memoryUsage()));
+
+    out << "# HELP shinra_step_seconds Time to compute one generation.\n"
+        << "# TYPE shinra_step_seconds histogram\n";
+    uint64_t cumulative = 0;
+    for (int bucket = 0; bucket < STEP_BUCKETS; ++bucket) {
+        cumulative += stepCounts[bucket];
+        out << "shinra_step_seconds_bucket{le=\"" << STEP_BOUNDS[bucket] << "\"} " << cumulative << '\n';
+    }
+    out << "shinra_step_seconds_bucket{le=\"+Inf\"} " << stepCount << '\n'
+        << "shinra_step_seconds_sum " << stepSum << '\n'
+        << "shinra_step_seconds_count " << stepCount << '\n';
+
+    writeMetric(out, "process_resident_memory_bytes", "gauge", "Resident set size.", static_cast<double>(process.rss_bytes));
+    writeMetric(out, "process_cpu_seconds_total", "counter", "User and system CPU time.", process.cpu_seconds);
+    writeMetric(out, "process_threads", "gauge", "Threads in the process.", static_cast<double>(process.threads));
+    writeMetric(out, "shinra_thread_utilization", "gauge", "CPU time over wall time times cores since the previous write.", utilization);
+
+    std::string tmp = path + ".tmp";
+    std::ofstream ofs(tmp, std::ios::trunc);
+    ofs << out.str();
+    ofs.close();
+    if (!ofs || std::rename(tmp.c_str(), path.c_str()) != 0) {
+        std::remove(tmp.c_str());
+        return false;
+    }
+    return true;
+}
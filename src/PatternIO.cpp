@@ -0,0 +1,498 @@
+#include "PatternIO.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <unordered_map>
+
+namespace {
+
+const size_t IO_CHUNK = 1 << 20;
+
+std::string trim(const std::string& text) {
+    size_t begin = text.find_first_not_of(" \t\r\n");
+    if (begin == std::string::npos) return "";
+    size_t end = text.find_last_not_of(" \t\r\n");
+    return text.substr(begin, end - begin + 1);
+}
+
+// "x = 3, y = 3, rule = B3/S23"
+void parseHeader(const std::string& line, RuleSet& rule) {
+    size_t start = 0;
+    while (start < line.size()) {
+        size_t comma = line.find(',', start);
+        if (comma == std::string::npos) comma = line.size();
+        std::string field = line.substr(start, comma - start);
+        size_t equals = field.find('=');
+        if (equals != std::string::npos && trim(field.substr(0, equals)) == "rule") {
+            std::string value = trim(field.substr(equals + 1));
+            if (!parseRule(value, rule)) {
+                std::cerr << "Unsupported rule " << value << ", keeping current rules" << std::endl;
+            }
+        }
+        start = comma + 1;
+    }
+}
+
+}
+
+bool hasExtension(const std::string& filename, const std::string& extension) {
+    if (filename.size() < extension.size()) return false;
+    return std::equal(extension.rbegin(), extension.rend(), filename.rbegin(),
+                      [](char a, char b) { return std::tolower(a) == std::tolower(b); });
+}
+
+bool parseRule(const std::string& text, RuleSet& rule) {
+    std::string birth, survival;
+    std::string upper;
+    for (char c : text) upper += static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+
+    size_t slash = upper.find('/');
+    if (slash == std::string::npos) return false;
+    std::string left = upper.substr(0, slash), right = upper.substr(slash + 1);
+    if (!left.empty() && left[0] == 'B') {
+        birth = left.substr(1);
+        survival = right.substr(right.empty() || right[0] != 'S' ? 0 : 1);
+    } else if (!right.empty() && right[0] == 'B') {
+        birth = right.substr(1);
+        survival = left.substr(left.empty() || left[0] != 'S' ? 0 : 1);
+    } else {
+        // Notation historique "S/B", ex. "23/3"
+        survival = left;
+        birth = right;
+    }
+    std::sort(birth.begin(), birth.end());
+    std::sort(survival.begin(), survival.end());
+
+    if (survival != "23") return false;
+    if (birth == "3") rule = RuleSet::CONWAY;
+    else if (birth == "36") rule = RuleSet::HIGHLIFE;
+    else return false;
+    return true;
+}
+
+const char* ruleString(RuleSet rule) {
+    switch (rule) {
+        case RuleSet::HIGHLIFE: return "B36/S23";
+        default: return "B3/S23";
+    }
+}
+
+bool readRLE(const std::string& filename, std::vector<Cell>& cells, RuleSet& rule) {
+    std::ifstream ifs(filename, std::ios::binary);
+    if (!ifs) return false;
+
+    cells.clear();
+    std::vector<char> buffer(IO_CHUNK);
+    std::string line;       // Ligne d'en-tête ou de commentaire en cours
+    bool inLine = false;    // On est dans une ligne '#' ou 'x ='
+    bool atLineStart = true;
+    bool inBody = false;    // Les lignes d'en-tête ne sont reconnues qu'avant le motif
+    bool done = false;
+    int64_t origin_x = 0;
+    int64_t x = 0, y = 0;
+    int64_t run = 0;
+
+    while (!done && ifs) {
+        ifs.read(buffer.data(), buffer.size());
+        std::streamsize got = ifs.gcount();
+        for (std::streamsize i = 0; i < got && !done; ++i) {
+            char c = buffer[i];
+            if (inLine) {
+                if (c != '\n') {
+                    line += c;
+                    continue;
+                }
+                inLine = false;
+                atLineStart = true;
+                if (line[0] == 'x') {
+                    parseHeader(line, rule);
+                } else if (line.compare(0, 6, "#CXRLE") == 0) {
+                    size_t pos = line.find("Pos=");
+                    long long px, py;
+                    if (pos != std::string::npos && std::sscanf(line.c_str() + pos + 4, "%lld,%lld", &px, &py) == 2) {
+                        origin_x = x = px;
+                        y = py;
+                    }
+                }
+                line.clear();
+                continue;
+            }
+            if (atLineStart && !inBody && (c == '#' || c == 'x')) {
+                inLine = true;
+                line = c;
+                continue;
+            }
+            atLineStart = (c == '\n');
+            if (!std::isspace(static_cast<unsigned char>(c))) inBody = true;
+
+            if (c >= '0' && c <= '9') {
+                run = run * 10 + (c - '0');
+            } else if (c == 'b' || c == '.') {
+                x += run ? run : 1;
+                run = 0;
+            } else if (c == '$') {
+                y += run ? run : 1;
+                x = origin_x;
+                run = 0;
+            } else if (c == '!') {
+                done = true;
+            } else if (std::isalpha(static_cast<unsigned char>(c))) {
+                // 'o' et les états multiples comptent comme vivants
+                for (int64_t k = 0, n = run ? run : 1; k < n; ++k) cells.push_back({x++, y});
+                run = 0;
+            }
+        }
+    }
+
+    std::sort(cells.begin(), cells.end());
+    cells.erase(std::unique(cells.begin(), cells.end()), cells.end());
+    return true;
+}
+
+bool readCells(const std::string& filename, std::vector<Cell>& cells) {
+    std::ifstream ifs(filename);
+    if (!ifs) return false;
+
+    cells.clear();
+    std::string line;
+    int64_t y = 0;
+    while (std::getline(ifs, line)) {
+        if (!line.empty() && line[0] == '!') continue;
+        for (size_t x = 0; x < line.size(); ++x) {
+            char c = line[x];
+            if (c == 'O' || c == '*') cells.push_back({static_cast<int64_t>(x), y});
+            else if (c != '.' && c != '\r' && c != ' ' && c != '\t') return false;
+        }
+        y++;
+    }
+    std::sort(cells.begin(), cells.end());
+    return true;
+}
+
+bool writeRLE(const std::string& filename, const std::vector<Cell>& cells, RuleSet rule,
+              std::atomic<float>* progress) {
+    std::ofstream ofs(filename, std::ios::binary);
+    if (!ofs) return false;
+
+    // Les lignes RLE se lisent rangée par rangée : on quitte l'ordre de Morton
+    std::vector<Cell> rows(cells);
+    std::sort(rows.begin(), rows.end(), [](const Cell& a, const Cell& b) {
+        return a.y != b.y ? a.y < b.y : a.x < b.x;
+    });
+
+    int64_t min_x = 0, min_y = 0, max_x = -1, max_y = -1;
+    if (!rows.empty()) {
+        min_x = max_x = rows.front().x;
+        min_y = rows.front().y;
+        max_y = rows.back().y;
+        for (const auto& cell : rows) {
+            min_x = std::min(min_x, cell.x);
+            max_x = std::max(max_x, cell.x);
+        }
+    }
+
+    std::string out;
+    out.reserve(IO_CHUNK + 128);
+    out += "#CXRLE Pos=" + std::to_string(min_x) + "," + std::to_string(min_y) + "\n";
+    out += "x = " + std::to_string(max_x - min_x + 1) + ", y = " + std::to_string(max_y - min_y + 1) +
+           ", rule = " + ruleString(rule) + "\n";
+
+    size_t line_length = 0;
+    size_t emitted = 0; // Cellules déjà encodées, pour la progression
+    auto emit = [&](int64_t count, char tag) {
+        if (count <= 0) return;
+        std::string token = (count > 1 ? std::to_string(count) : "") + tag;
+        if (line_length + token.size() > 70) {
+            out += '\n';
+            line_length = 0;
+        }
+        out += token;
+        line_length += token.size();
+        if (out.size() >= IO_CHUNK) {
+            ofs.write(out.data(), out.size());
+            out.clear();
+            if (progress) *progress = static_cast<float>(emitted) / rows.size();
+        }
+    };
+
+    int64_t y = min_y, x = min_x;
+    size_t i = 0;
+    while (i < rows.size()) {
+        if (rows[i].y != y) {
+            emit(rows[i].y - y, '$');
+            y = rows[i].y;
+            x = min_x;
+        }
+        size_t j = i + 1;
+        while (j < rows.size() && rows[j].y == y && rows[j].x == rows[j - 1].x + 1) j++;
+        emit(rows[i].x - x, 'b');
+        emit(static_cast<int64_t>(j - i), 'o');
+        x = rows[j - 1].x + 1;
+        i = emitted = j;
+    }
+    out += "!\n";
+    ofs.write(out.data(), out.size());
+    if (progress) *progress = 1.0f;
+    ofs.close(); // Le dernier tampon peut encore échouer
+    return static_cast<bool>(ofs);
+}
+
+namespace {
+
+struct MacroNode {
+    int level;          // 3 pour une feuille 8x8
+    uint64_t child[4];  // nw, ne, sw, se (0 = vide)
+    uint64_t leaf;      // Feuille : rangée r dans l'octet r, bit c = colonne c
+    uint64_t population;
+    uint64_t tiles;     // Tuiles 64x64 non vides (niveau 6 et au-dessus)
+};
+
+// Coin haut-gauche de la racine de niveau level, en coordonnées non signées
+// (Cell::key) : la racine couvre [-2^(level-1), 2^(level-1)).
+uint64_t macroOrigin(int level) {
+    return level >= 64 ? 0 : (1ULL << 63) - (1ULL << (level - 1));
+}
+
+void expandMacroNode(const std::vector<MacroNode>& nodes, uint64_t id, uint64_t ox, uint64_t oy,
+                     std::vector<Cell>& cells) {
+    if (id == 0) return;
+    const MacroNode& node = nodes[id];
+    if (node.level == 3) {
+        size_t first = cells.size();
+        for (int r = 0; r < 8; ++r) {
+            uint64_t bits = (node.leaf >> (8 * r)) & 0xFF;
+            while (bits) {
+                int c = __builtin_ctzll(bits);
+                cells.push_back({static_cast<int64_t>((ox + c) ^ (1ULL << 63)),
+                                 static_cast<int64_t>((oy + r) ^ (1ULL << 63))});
+                bits &= bits - 1;
+            }
+        }
+        std::sort(cells.begin() + first, cells.end());
+        return;
+    }
+    // nw, ne, sw, se : c'est aussi l'ordre de Morton, la liste reste triée
+    uint64_t half = 1ULL << (node.level - 1);
+    expandMacroNode(nodes, node.child[0], ox, oy, cells);
+    expandMacroNode(nodes, node.child[1], ox + half, oy, cells);
+    expandMacroNode(nodes, node.child[2], ox, oy + half, cells);
+    expandMacroNode(nodes, node.child[3], ox + half, oy + half, cells);
+}
+
+// Recopie le noeud (niveau 6 au plus) dans les rangées d'une tuile, (ox, oy)
+// étant sa position dans la tuile
+void expandMacroRows(const std::vector<MacroNode>& nodes, uint64_t id, int ox, int oy, uint64_t* rows) {
+    if (id == 0) return;
+    const MacroNode& node = nodes[id];
+    if (node.level == 3) {
+        for (int r = 0; r < 8; ++r) rows[oy + r] |= ((node.leaf >> (8 * r)) & 0xFF) << ox;
+        return;
+    }
+    int half = 1 << (node.level - 1);
+    expandMacroRows(nodes, node.child[0], ox, oy, rows);
+    expandMacroRows(nodes, node.child[1], ox + half, oy, rows);
+    expandMacroRows(nodes, node.child[2], ox, oy + half, rows);
+    expandMacroRows(nodes, node.child[3], ox + half, oy + half, rows);
+}
+
+// Noeud de niveau 6 ou plus, aligné sur les tuiles : une tuile par noeud de
+// 64x64 non vide, dans l'ordre de Morton
+void expandMacroTiles(const std::vector<MacroNode>& nodes, uint64_t id, uint64_t ox, uint64_t oy,
+                      std::vector<Tile>& tiles) {
+    if (id == 0) return;
+    const MacroNode& node = nodes[id];
+    if (node.level == 6) {
+        Tile tile = { static_cast<int64_t>(ox ^ (1ULL << 63)) >> 6, static_cast<int64_t>(oy ^ (1ULL << 63)) >> 6, {} };
+        expandMacroRows(nodes, id, 0, 0, tile.rows);
+        tiles.push_back(tile);
+        return;
+    }
+    uint64_t half = 1ULL << (node.level - 1);
+    expandMacroTiles(nodes, node.child[0], ox, oy, tiles);
+    expandMacroTiles(nodes, node.child[1], ox + half, oy, tiles);
+    expandMacroTiles(nodes, node.child[2], ox, oy + half, tiles);
+    expandMacroTiles(nodes, node.child[3], ox + half, oy + half, tiles);
+}
+
+struct MacroKey {
+    uint64_t child[4];
+    bool operator==(const MacroKey& other) const {
+        return std::equal(child, child + 4, other.child);
+    }
+};
+
+struct MacroKeyHash {
+    size_t operator()(const MacroKey& key) const {
+        uint64_t h = 0xcbf29ce484222325ULL;
+        for (uint64_t c : key.child) h = (h ^ c) * 0x100000001b3ULL;
+        return static_cast<size_t>(h);
+    }
+};
+
+// Construction du quadtree avec partage des sous-arbres identiques
+struct MacroBuilder {
+    const std::vector<Cell>& cells;
+    std::vector<std::string> lines;
+    std::unordered_map<uint64_t, uint64_t> leaves;
+    std::unordered_map<MacroKey, uint64_t, MacroKeyHash> nodes[65];
+
+    explicit MacroBuilder(const std::vector<Cell>& c) : cells(c) {}
+
+    using Iter = std::vector<Cell>::const_iterator;
+
+    // [begin, end) contient au moins toutes les cellules du carré
+    uint64_t build(int level, uint64_t ox, uint64_t oy, Iter begin, Iter end) {
+        uint64_t span = level >= 64 ? ~0ULL : (1ULL << level) - 1;
+        auto toCell = [](uint64_t ux, uint64_t uy) {
+            return Cell{static_cast<int64_t>(ux ^ (1ULL << 63)), static_cast<int64_t>(uy ^ (1ULL << 63))};
+        };
+        // Un carré aligné est contigu dans l'ordre de Morton (la racine ne l'est
+        // pas forcément : elle est centrée sur l'origine)
+        if (level < 64 && (ox & span) == 0 && (oy & span) == 0) {
+            begin = std::lower_bound(begin, end, toCell(ox, oy));
+            end = std::upper_bound(begin, end, toCell(ox + span, oy + span));
+            if (begin == end) return 0;
+        }
+
+        if (level == 3) {
+            uint64_t leaf = 0;
+            for (auto it = begin; it != end; ++it) {
+                uint64_t c = Cell::key(it->x) - ox, r = Cell::key(it->y) - oy;
+                leaf |= 1ULL << (8 * r + c);
+            }
+            if (leaf == 0) return 0;
+            auto found = leaves.find(leaf);
+            if (found != leaves.end()) return found->second;
+            std::string line;
+            for (int r = 0; r < 8; ++r) {
+                uint64_t row = (leaf >> (8 * r)) & 0xFF;
+                for (int c = 0; row >> c; ++c) line += ((row >> c) & 1) ? '*' : '.';
+                line += '$';
+            }
+            while (line.size() > 1 && line[line.size() - 1] == '$' && line[line.size() - 2] == '$') {
+                line.pop_back();
+            }
+            lines.push_back(line);
+            return leaves[leaf] = lines.size();
+        }
+
+        uint64_t half = 1ULL << (level - 1);
+        MacroKey key = {{ build(level - 1, ox, oy, begin, end), build(level - 1, ox + half, oy, begin, end),
+                          build(level - 1, ox, oy + half, begin, end),
+                          build(level - 1, ox + half, oy + half, begin, end) }};
+        if (!key.child[0] && !key.child[1] && !key.child[2] && !key.child[3]) return 0;
+        auto found = nodes[level].find(key);
+        if (found != nodes[level].end()) return found->second;
+        lines.push_back(std::to_string(level) + " " + std::to_string(key.child[0]) + " " +
+                        std::to_string(key.child[1]) + " " + std::to_string(key.child[2]) + " " +
+                        std::to_string(key.child[3]));
+        return nodes[level][key] = lines.size();
+    }
+};
+
+}
+
+bool readMacrocell(const std::string& filename, std::vector<Tile>& tiles, RuleSet& rule) {
+    std::ifstream ifs(filename);
+    if (!ifs) return false;
+
+    std::string line;
+    if (!std::getline(ifs, line) || line.compare(0, 4, "[M2]") != 0) return false;
+
+    // Noeud 0 : vide
+    std::vector<MacroNode> nodes(1, MacroNode{0, {0, 0, 0, 0}, 0, 0, 0});
+    while (std::getline(ifs, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line.empty()) continue;
+        if (line[0] == '#') {
+            if (line.size() > 3 && line[1] == 'R' && !parseRule(trim(line.substr(2)), rule)) {
+                std::cerr << "Unsupported rule " << trim(line.substr(2)) << ", keeping current rules" << std::endl;
+            }
+            continue;
+        }
+
+        MacroNode node = {3, {0, 0, 0, 0}, 0, 0, 0};
+        if (line[0] == '.' || line[0] == '*' || line[0] == '$') {
+            int r = 0, c = 0;
+            for (char ch : line) {
+                if (ch == '$') {
+                    r++;
+                    c = 0;
+                } else if (r < 8 && c < 8) {
+                    if (ch == '*') node.leaf |= 1ULL << (8 * r + c);
+                    c++;
+                } else {
+                    return false;
+                }
+            }
+            node.population = __builtin_popcountll(node.leaf);
+        } else {
+            unsigned long long nw, ne, sw, se;
+            if (std::sscanf(line.c_str(), "%d %llu %llu %llu %llu", &node.level, &nw, &ne, &sw, &se) != 5) return false;
+            if (node.level < 4 || node.level > 64) return false;
+            node.child[0] = nw;
+            node.child[1] = ne;
+            node.child[2] = sw;
+            node.child[3] = se;
+            for (uint64_t child : node.child) {
+                // Les fils sont déjà définis et d'un niveau juste en dessous
+                if (child >= nodes.size() || (child && nodes[child].level != node.level - 1)) return false;
+                uint64_t population = nodes[child].population;
+                node.population = node.population + population < node.population ? ~0ULL : node.population + population;
+                uint64_t count = nodes[child].tiles;
+                node.tiles = node.tiles + count < node.tiles ? ~0ULL : node.tiles + count;
+            }
+            if (node.level == 6 && node.population) node.tiles = 1;
+        }
+        nodes.push_back(node);
+    }
+    tiles.clear();
+    if (nodes.size() < 2) return true;
+
+    // Une racine de moins de 128x128 n'est pas alignée sur les tuiles : elle
+    // passe par ses quelques cellules
+    const MacroNode& root = nodes.back();
+    if (root.level < 7) {
+        std::vector<Cell> cells;
+        expandMacroNode(nodes, nodes.size() - 1, macroOrigin(root.level), macroOrigin(root.level), cells);
+        cellsToTiles(cells, tiles);
+        return true;
+    }
+    if (root.tiles > MACROCELL_MAX_TILES) {
+        std::cerr << "Macrocell pattern too large: " << root.tiles << " tiles" << std::endl;
+        return false;
+    }
+    tiles.reserve(root.tiles);
+    expandMacroTiles(nodes, nodes.size() - 1, macroOrigin(root.level), macroOrigin(root.level), tiles);
+    return true;
+}
+
+bool writeMacrocell(const std::string& filename, const std::vector<Cell>& cells, RuleSet rule,
+                    std::atomic<float>* progress) {
+    std::ofstream ofs(filename);
+    if (!ofs) return false;
+
+    // Plus petite racine centrée qui contient toutes les cellules
+    int level = 3;
+    for (const auto& cell : cells) {
+        while (level < 64) {
+            int64_t half = int64_t(1) << (level - 1);
+            if (cell.x >= -half && cell.x < half && cell.y >= -half && cell.y < half) break;
+            level++;
+        }
+    }
+
+    MacroBuilder builder(cells);
+    builder.build(level, macroOrigin(level), macroOrigin(level), cells.begin(), cells.end());
+
+    ofs << "[M2] (shinra_tensei)\n";
+    ofs << "#R " << ruleString(rule) << "\n";
+    for (const auto& line : builder.lines) ofs << line << "\n";
+    if (progress) *progress = 1.0f;
+    ofs.close();
+    return static_cast<bool>(ofs);
+}
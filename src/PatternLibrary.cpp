@@ -0,0 +1,206 @@
+#include "PatternLibrary.hpp"
+#include "Lz.hpp"
+#include "PatternIO.hpp"
+#include "Trace.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <thread>
+#include <unordered_map>
+
+namespace {
+
+template <typename T>
+void writeValue(std::ofstream& ofs, const T& value) {
+    ofs.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+template <typename T>
+bool readValue(std::ifstream& ifs, T& value) {
+    return static_cast<bool>(ifs.read(reinterpret_cast<char*>(&value), sizeof(value)));
+}
+
+void parsePattern(PatternEntry& entry) {
+    TRACE_ZONE("parse pattern");
+    std::vector<Cell> cells;
+    RuleSet rule = RuleSet::CONWAY;
+    entry.valid = hasExtension(entry.path, ".rle") ? readRLE(entry.path, cells, rule) : readCells(entry.path, cells);
+    entry.tiles.clear();
+    entry.population = 0;
+    if (!entry.valid) return;
+
+    entry.rule = rule;
+    entry.population = cells.size();
+    entry.min_x = entry.min_y = entry.max_x = entry.max_y = 0;
+    if (!cells.empty()) {
+        entry.min_x = entry.max_x = cells.front().x;
+        entry.min_y = entry.max_y = cells.front().y;
+        for (const auto& cell : cells) {
+            entry.min_x = std::min(entry.min_x, cell.x);
+            entry.max_x = std::max(entry.max_x, cell.x);
+            entry.min_y = std::min(entry.min_y, cell.y);
+            entry.max_y = std::max(entry.max_y, cell.y);
+        }
+    }
+    cellsToTiles(cells, entry.tiles);
+}
+
+}
+
+PatternLibrary::PatternLibrary(const std::string& directory, const std::string& index_path)
+    : directory(directory), index_path(index_path.empty() ? directory + "/.index" : index_path) {}
+
+const std::vector<PatternEntry>& PatternLibrary::patterns() const {
+    return entries;
+}
+
+size_t PatternLibrary::scan(unsigned thread_count) {
+    if (!index_loaded) {
+        index_loaded = true;
+        if (!loadIndex()) entries.clear(); // Index absent ou illisible : tout est relu
+    }
+
+    std::unordered_map<std::string, size_t> known;
+    for (size_t i = 0; i < entries.size(); ++i) known[entries[i].path] = i;
+
+    // Liste du dossier, triée par chemin
+    std::vector<PatternEntry> next;
+    std::error_code error;
+    for (std::filesystem::recursive_directory_iterator it(directory, error), end; !error && it != end; it.increment(error)) {
+        std::string path = it->path().string();
+        if (!it->is_regular_file(error) || !(hasExtension(path, ".rle") || hasExtension(path, ".cells"))) continue;
+        PatternEntry entry;
+        entry.path = path;
+        entry.name = it->path().stem().string();
+        entry.size = it->file_size(error);
+        entry.mtime = static_cast<int64_t>(it->last_write_time(error).time_since_epoch().count());
+        next.push_back(std::move(entry));
+    }
+    std::sort(next.begin(), next.end(), [](const PatternEntry& a, const PatternEntry& b) { return a.path < b.path; });
+
+    // Un fichier dont la taille et la date n'ont pas bougé reprend son entrée
+    std::vector<size_t> changed;
+    for (size_t i = 0; i < next.size(); ++i) {
+        auto old = known.find(next[i].path);
+        if (old != known.end() && entries[old->second].size == next[i].size &&
+            entries[old->second].mtime == next[i].mtime) {
+            next[i] = std::move(entries[old->second]);
+        } else {
+            changed.push_back(i);
+        }
+    }
+    bool removed = next.size() - changed.size() < entries.size();
+
+    // Analyse des fichiers modifiés, répartis entre les threads
+    if (thread_count == 0) thread_count = std::max(1u, std::thread::hardware_concurrency());
+    thread_count = static_cast<unsigned>(std::min<size_t>(thread_count, changed.size()));
+    std::atomic<size_t> cursor{0};
+    auto work = [&]() {
+        for (size_t i; (i = cursor++) < changed.size();) parsePattern(next[changed[i]]);
+    };
+    std::vector<std::thread> workers;
+    for (unsigned t = 1; t < thread_count; ++t) workers.emplace_back(work);
+    work();
+    for (auto& worker : workers) worker.join();
+
+    entries.swap(next);
+    if ((!changed.empty() || removed) && !saveIndex()) {
+        std::cerr << "Failed to write pattern index " << index_path << std::endl;
+    }
+    return changed.size();
+}
+
+void PatternLibrary::patternCells(size_t index, int64_t x, int64_t y, std::vector<Cell>& out) const {
+    out.clear();
+    if (index >= entries.size()) return;
+    const PatternEntry& entry = entries[index];
+    for (const auto& tile : entry.tiles) appendTileCells(tile.tx, tile.ty, tile.rows, out);
+    for (auto& cell : out) {
+        cell.x += x - entry.min_x;
+        cell.y += y - entry.min_y;
+    }
+}
+
+bool PatternLibrary::loadIndex() {
+    std::ifstream ifs(index_path, std::ios::binary);
+    char magic[8];
+    uint32_t version;
+    uint64_t count;
+    if (!ifs.read(magic, sizeof(magic)) || std::memcmp(magic, PATTERN_INDEX_MAGIC, sizeof(magic)) != 0 ||
+        !readValue(ifs, version) || version != PATTERN_INDEX_VERSION || !readValue(ifs, count)) {
+        return false;
+    }
+
+    entries.clear();
+    std::vector<uint8_t> packed;
+    for (uint64_t i = 0; i < count; ++i) {
+        PatternEntry entry;
+        uint32_t path_size, rule, valid;
+        uint64_t tile_count, packed_size;
+        if (!readValue(ifs, path_size) || path_size > 4096) return false;
+        entry.path.resize(path_size);
+        if (!ifs.read(&entry.path[0], path_size)) return false;
+        if (!readValue(ifs, entry.mtime) || !readValue(ifs, entry.size) || !readValue(ifs, rule) ||
+            !readValue(ifs, valid) || !readValue(ifs, entry.population) ||
+            !readValue(ifs, entry.min_x) || !readValue(ifs, entry.min_y) ||
+            !readValue(ifs, entry.max_x) || !readValue(ifs, entry.max_y) ||
+            !readValue(ifs, tile_count) || !readValue(ifs, packed_size)) {
+            return false;
+        }
+        if (rule >= static_cast<uint32_t>(RuleSet::COUNT) || tile_count > (1ULL << 24) ||
+            packed_size > 2 * tile_count * sizeof(Tile) + 64) {
+            return false;
+        }
+        packed.resize(packed_size);
+        entry.tiles.resize(tile_count);
+        if (!ifs.read(reinterpret_cast<char*>(packed.data()), packed_size) ||
+            !lzDecompress(packed.data(), packed.size(), reinterpret_cast<uint8_t*>(entry.tiles.data()),
+                          tile_count * sizeof(Tile))) {
+            return false;
+        }
+        entry.rule = static_cast<RuleSet>(rule);
+        entry.valid = valid != 0;
+        entry.name = std::filesystem::path(entry.path).stem().string();
+        entries.push_back(std::move(entry));
+    }
+    return true;
+}
+
+// Écrit à côté puis renomme, comme les sauvegardes
+bool PatternLibrary::saveIndex() const {
+    std::string tmp = index_path + ".tmp";
+    std::ofstream ofs(tmp, std::ios::binary | std::ios::trunc);
+    ofs.write(PATTERN_INDEX_MAGIC, sizeof(PATTERN_INDEX_MAGIC));
+    writeValue(ofs, PATTERN_INDEX_VERSION);
+    writeValue(ofs, static_cast<uint64_t>(entries.size()));
+    std::vector<uint8_t> packed;
+    for (const auto& entry : entries) {
+        writeValue(ofs, static_cast<uint32_t>(entry.path.size()));
+        ofs.write(entry.path.data(), entry.path.size());
+        writeValue(ofs, entry.mtime);
+        writeValue(ofs, entry.size);
+        writeValue(ofs, static_cast<uint32_t>(entry.rule));
+        writeValue(ofs, static_cast<uint32_t>(entry.valid));
+        writeValue(ofs, entry.population);
+        writeValue(ofs, entry.min_x);
+        writeValue(ofs, entry.min_y);
+        writeValue(ofs, entry.max_x);
+        writeValue(ofs, entry.max_y);
+        packed.clear();
+        lzCompress(reinterpret_cast<const uint8_t*>(entry.tiles.data()), entry.tiles.size() * sizeof(Tile), packed);
+        writeValue(ofs, static_cast<uint64_t>(entry.tiles.size()));
+        writeValue(ofs, static_cast<uint64_t>(packed.size()));
+        ofs.write(reinterpret_cast<const char*>(packed.data()), packed.size());
+    }
+    ofs.close();
+    if (!ofs || std::rename(tmp.c_str(), index_path.c_str()) != 0) {
+        std::remove(tmp.c_str());
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,234 @@
+#include "Recording.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+RecordingWriter::RecordingWriter(const std::string& path, uint32_t keyframe_interval)
+    : out(path, std::ios::binary | std::ios::trunc), keyframe_interval(std::max(1u, keyframe_interval)) {
+    RecordingHeader header = {};
+    std::memcpy(header.magic, RECORDING_MAGIC, sizeof(header.magic));
+    header.version = RECORDING_VERSION;
+    header.keyframe_interval = this->keyframe_interval;
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    failed = !out;
+    worker = std::thread(&RecordingWriter::run, this);
+}
+
+RecordingWriter::~RecordingWriter() {
+    if (!finished) finish();
+}
+
+bool RecordingWriter::good() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return !failed;
+}
+
+uint64_t RecordingWriter::frameCount() const {
+    return frame_count;
+}
+
+bool RecordingWriter::append(uint64_t generation, const Grid& grid) {
+    if (finished) return false;
+    GridSnapshot snapshot = grid.snapshot();
+    snapshot.generation = generation;
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        space.wait(lock, [this]() { return failed || queue.size() < RECORDING_QUEUE_FRAMES; });
+        if (failed) return false;
+        queue.push_back(std::move(snapshot));
+    }
+    wake.notify_one();
+    frame_count++;
+    return true;
+}
+
+void RecordingWriter::run() {
+    GridSnapshot snapshot;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this]() { return stopping || failed || !queue.empty(); });
+            if (failed || queue.empty()) return; // finish() : toutes les frames sont écrites
+            snapshot = std::move(queue.front());
+            queue.pop_front();
+        }
+        space.notify_one();
+        if (!write(snapshot)) {
+            std::lock_guard<std::mutex> lock(mutex);
+            failed = true;
+            queue.clear();
+            space.notify_one();
+            return;
+        }
+    }
+}
+
+bool RecordingWriter::write(const GridSnapshot& snapshot) {
+    std::vector<Tile> next[2];
+    snapshot.tiles(next[0]);
+    cellsToTiles(snapshot.godCells, next[1]);
+
+    // Même sans changement, chaque frame a son enregistrement (delta vide) :
+    // le numéro de frame reste la position dans le fichier
+    bool keyframe = written_frames % keyframe_interval == 0;
+    std::vector<JournalTile> entries;
+    for (uint64_t layer = 0; layer < 2; ++layer) {
+        diffTiles(keyframe ? std::vector<Tile>() : previous[layer], next[layer], layer, entries);
+    }
+    uint64_t offset = static_cast<uint64_t>(out.tellp());
+    if (!writeJournalRecord(out, keyframe ? JournalRecord::KEYFRAME : JournalRecord::DELTA,
+                            snapshot.generation, snapshot.rules, entries)) {
+        return false;
+    }
+    if (keyframe) index.push_back({written_frames, offset});
+    previous[0].swap(next[0]);
+    previous[1].swap(next[1]);
+    written_frames++;
+    return true;
+}
+
+bool RecordingWriter::finish() {
+    if (finished) return !failed && !out.fail();
+    finished = true;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    worker.join();
+    if (failed) {
+        out.close();
+        return false;
+    }
+
+    RecordingFooter footer = {};
+    footer.index_offset = static_cast<uint64_t>(out.tellp());
+    footer.index_count = index.size();
+    footer.frame_count = written_frames;
+    std::memcpy(footer.magic, RECORDING_INDEX_MAGIC, sizeof(footer.magic));
+    out.write(reinterpret_cast<const char*>(index.data()), index.size() * sizeof(RecordingIndexEntry));
+    out.write(reinterpret_cast<const char*>(&footer), sizeof(footer));
+    out.close();
+    return !out.fail();
+}
+
+bool RecordingReader::open(const std::string& path) {
+    in.open(path, std::ios::binary);
+    RecordingHeader header;
+    if (!in.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        std::memcmp(header.magic, RECORDING_MAGIC, sizeof(RECORDING_MAGIC)) != 0 ||
+        header.version != RECORDING_VERSION) {
+        return false;
+    }
+    if (!readFooter() && !rebuildIndex(sizeof(header))) return false;
+    positioned = false;
+    return frame_count > 0 && !index.empty() && index.front().frame == 0;
+}
+
+uint64_t RecordingReader::frameCount() const {
+    return frame_count;
+}
+
+uint64_t RecordingReader::frame() const {
+    return current_frame;
+}
+
+uint64_t RecordingReader::generation() const {
+    return current_generation;
+}
+
+bool RecordingReader::readFooter() {
+    in.clear();
+    in.seekg(0, std::ios::end);
+    uint64_t size = static_cast<uint64_t>(in.tellg());
+    if (size < sizeof(RecordingHeader) + sizeof(RecordingFooter)) return false;
+
+    RecordingFooter footer;
+    in.seekg(size - sizeof(footer));
+    if (!in.read(reinterpret_cast<char*>(&footer), sizeof(footer)) ||
+        std::memcmp(footer.magic, RECORDING_INDEX_MAGIC, sizeof(RECORDING_INDEX_MAGIC)) != 0) {
+        return false;
+    }
+    if (footer.index_offset > size - sizeof(footer) ||
+        (size - sizeof(footer) - footer.index_offset) / sizeof(RecordingIndexEntry) != footer.index_count) {
+        return false;
+    }
+    index.resize(footer.index_count);
+    in.seekg(footer.index_offset);
+    if (!in.read(reinterpret_cast<char*>(index.data()), index.size() * sizeof(RecordingIndexEntry))) return false;
+    frame_count = footer.frame_count;
+    return std::all_of(index.begin(), index.end(), [this](const RecordingIndexEntry& entry) {
+        return entry.frame < frame_count;
+    });
+}
+
+// Enregistrement interrompu : on parcourt les en-têtes sans décompresser, en
+// s'arrêtant au premier enregistrement incomplet
+bool RecordingReader::rebuildIndex(uint64_t data_start) {
+    in.clear();
+    in.seekg(0, std::ios::end);
+    uint64_t size = static_cast<uint64_t>(in.tellg());
+    index.clear();
+    frame_count = 0;
+
+    uint64_t offset = data_start;
+    JournalRecordHeader header;
+    in.seekg(offset);
+    while (in.read(reinterpret_cast<char*>(&header), sizeof(header)) && header.magic == JOURNAL_MAGIC) {
+        uint64_t end = offset + sizeof(header) + header.payload_size;
+        if (end > size) break;
+        if (header.type == static_cast<uint32_t>(JournalRecord::KEYFRAME)) index.push_back({frame_count, offset});
+        frame_count++;
+        offset = end;
+        in.seekg(offset);
+    }
+    in.clear();
+    return !index.empty();
+}
+
+bool RecordingReader::readFrame() {
+    JournalRecordHeader header;
+    if (!readJournalRecord(in, header, entries)) return false;
+    bool keyframe = header.type == static_cast<uint32_t>(JournalRecord::KEYFRAME);
+    for (uint64_t layer = 0; layer < 2; ++layer) {
+        if (keyframe) tiles[layer].clear();
+        applyTiles(tiles[layer], entries, layer);
+    }
+    current_generation = header.generation;
+    if (header.rule < static_cast<uint32_t>(RuleSet::COUNT)) rules = static_cast<RuleSet>(header.rule);
+    return true;
+}
+
+bool RecordingReader::seek(uint64_t target) {
+    if (frame_count == 0) return false;
+    target = std::min(target, frame_count - 1);
+
+    auto keyframe = std::upper_bound(index.begin(), index.end(), target,
+                                     [](uint64_t frame, const RecordingIndexEntry& entry) {
+                                         return frame < entry.frame;
+                                     }) - 1;
+    bool forward = positioned && current_frame <= target && current_frame >= keyframe->frame;
+    if (!forward) {
+        in.clear();
+        in.seekg(keyframe->offset);
+        positioned = readFrame();
+        if (!positioned) return false;
+        current_frame = keyframe->frame;
+    }
+    while (current_frame < target) {
+        if (!readFrame()) {
+            positioned = false;
+            return false;
+        }
+        current_frame++;
+    }
+    return true;
+}
+
+void RecordingReader::snapshot(GridSnapshot& out) const {
+    out.frozen.reset();
+    tilesToCells(tiles[0], out.aliveCells);
+    tilesToCells(tiles[1], out.godCells);
+    out.rules = rules;
+    out.generation = current_generation;
+}
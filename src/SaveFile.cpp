@@ -0,0 +1,390 @@
+#include "SaveFile.hpp"
+#include "Lz.hpp"
+#include "Tile.hpp"
+#include "Trace.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <fstream>
+#include <thread>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+void writeTiles(std::ofstream& ofs, const std::vector<Tile>& tiles,
+                size_t& written, size_t total, std::atomic<float>* progress) {
+    for (const auto& tile : tiles) {
+        ofs.write(reinterpret_cast<const char*>(tile.rows), sizeof(tile.rows));
+        if (progress && (++written & 1023) == 0) *progress = static_cast<float>(written) / total;
+    }
+}
+
+// Compresse les bitmaps par blocs de SAVE_BLOCK_TILES tuiles (vivantes puis
+// Dieu). La table des blocs précède les données : on garde les blocs en
+// mémoire le temps de connaître leurs tailles.
+void writeCompressed(std::ofstream& ofs, const std::vector<Tile>& aliveTiles,
+                     const std::vector<Tile>& godTiles, uint64_t data_offset,
+                     std::atomic<float>* progress) {
+    uint64_t total = aliveTiles.size() + godTiles.size();
+    uint64_t block_count = (total + SAVE_BLOCK_TILES - 1) / SAVE_BLOCK_TILES;
+    std::vector<std::vector<uint8_t>> blocks(block_count);
+    std::vector<SaveBlockEntry> table(block_count);
+    std::vector<uint64_t> raw(SAVE_BLOCK_TILES * TILE_SIZE);
+    uint64_t offset = data_offset + sizeof(block_count) + block_count * sizeof(SaveBlockEntry);
+    for (uint64_t b = 0; b < block_count; ++b) {
+        uint64_t first = b * SAVE_BLOCK_TILES;
+        uint64_t last = std::min(first + SAVE_BLOCK_TILES, total);
+        for (uint64_t i = first; i < last; ++i) {
+            const Tile& tile = i < aliveTiles.size() ? aliveTiles[i] : godTiles[i - aliveTiles.size()];
+            std::memcpy(&raw[(i - first) * TILE_SIZE], tile.rows, sizeof(tile.rows));
+        }
+        uint64_t raw_size = (last - first) * sizeof(Tile::rows);
+        lzCompress(reinterpret_cast<const uint8_t*>(raw.data()), raw_size, blocks[b]);
+        table[b] = { offset, blocks[b].size(), raw_size };
+        offset += blocks[b].size();
+        if (progress) *progress = static_cast<float>(last) / total;
+    }
+
+    ofs.write(reinterpret_cast<const char*>(&block_count), sizeof(block_count));
+    ofs.write(reinterpret_cast<const char*>(table.data()), table.size() * sizeof(SaveBlockEntry));
+    for (const auto& block : blocks) ofs.write(reinterpret_cast<const char*>(block.data()), block.size());
+}
+
+// Ancien format : nombre de cellules (size_t) puis paires d'int32 (x, y)
+bool readLegacyCells(const char*& data, const char* end, std::vector<Cell>& cells) {
+    size_t count = 0;
+    if (end - data < static_cast<ptrdiff_t>(sizeof(count))) return false;
+    std::memcpy(&count, data, sizeof(count));
+    data += sizeof(count);
+    if (count > static_cast<size_t>(end - data) / (2 * sizeof(int32_t))) return false;
+    cells.reserve(cells.size() + count);
+    for (size_t i = 0; i < count; ++i) {
+        int32_t xy[2];
+        std::memcpy(xy, data, sizeof(xy));
+        data += sizeof(xy);
+        cells.push_back({xy[0], xy[1]});
+    }
+    std::sort(cells.begin(), cells.end());
+    cells.erase(std::unique(cells.begin(), cells.end()), cells.end());
+    return true;
+}
+
+uint64_t fix64(uint64_t v, bool swap) { return swap ? __builtin_bswap64(v) : v; }
+uint32_t fix32(uint32_t v, bool swap) { return swap ? __builtin_bswap32(v) : v; }
+
+// Tuiles [first, last) de l'index, dont les bitmaps sont dans data (le fichier
+// mappé, ou un bloc décompressé qui commence à la position base_offset)
+bool decodeTiles(const char* data, uint64_t data_size, uint64_t base_offset,
+                 const SaveTileEntry* index, uint64_t first, uint64_t last, uint64_t alive_tiles,
+                 bool swap, std::vector<Cell>& alive, std::vector<Cell>& god) {
+    uint64_t rows[TILE_SIZE];
+    for (uint64_t i = first; i < last; ++i) {
+        uint64_t offset = fix64(index[i].offset, swap);
+        if (offset < base_offset) return false;
+        offset -= base_offset;
+        if (offset > data_size || data_size - offset < sizeof(rows)) return false;
+        const uint64_t* src = reinterpret_cast<const uint64_t*>(data + offset);
+        if (swap) {
+            for (int r = 0; r < TILE_SIZE; ++r) rows[r] = __builtin_bswap64(src[r]);
+            src = rows;
+        }
+        appendTileCells(static_cast<int64_t>(fix64(index[i].tx, swap)),
+                        static_cast<int64_t>(fix64(index[i].ty, swap)), src,
+                        i < alive_tiles ? alive : god);
+    }
+    return true;
+}
+
+// Répartit les blocs entre les coeurs. Chaque bloc remplit ses propres listes,
+// concaténées ensuite dans l'ordre : les tuiles étant rangées dans l'ordre de
+// Morton, le résultat reste trié.
+template <typename Decode>
+bool decodeBlocks(uint64_t block_count, Decode decode, std::vector<Cell>& alive, std::vector<Cell>& god) {
+    std::vector<std::vector<Cell>> aliveParts(block_count), godParts(block_count);
+    std::atomic<uint64_t> next{0};
+    std::atomic<bool> failed{false};
+    auto work = [&]() {
+        TRACE_ZONE("decode blocks");
+        for (uint64_t block; !failed && (block = next++) < block_count;) {
+            if (!decode(block, aliveParts[block], godParts[block])) failed = true;
+        }
+    };
+    uint64_t thread_count = std::min<uint64_t>(std::max(1u, std::thread::hardware_concurrency()), block_count);
+    std::vector<std::thread> workers;
+    for (uint64_t t = 1; t < thread_count; ++t) workers.emplace_back(work);
+    work();
+    for (auto& worker : workers) worker.join();
+    if (failed) return false;
+
+    for (auto* parts : { &aliveParts, &godParts }) {
+        std::vector<Cell>& cells = parts == &aliveParts ? alive : god;
+        size_t total = cells.size();
+        for (const auto& part : *parts) total += part.size();
+        cells.reserve(total);
+        for (const auto& part : *parts) cells.insert(cells.end(), part.begin(), part.end());
+    }
+    return true;
+}
+
+// Taille de l'en-tête selon la version (v2 s'arrête avant generation)
+size_t headerSize(uint32_t version) {
+    return version >= 3 ? sizeof(SaveHeader) : offsetof(SaveHeader, generation);
+}
+
+// Vérifie magic, boutisme et version ; swap indique s'il faut retourner les octets
+bool checkHeader(const SaveHeader* header, size_t size, bool& swap, uint32_t& version) {
+    if (size < headerSize(2) || std::memcmp(header->magic, SAVE_MAGIC, sizeof(SAVE_MAGIC)) != 0) return false;
+    swap = header->endian_mark != SAVE_ENDIAN_MARK;
+    if (swap && __builtin_bswap32(header->endian_mark) != SAVE_ENDIAN_MARK) return false;
+    version = fix32(header->version, swap);
+    return version >= 2 && version <= SAVE_VERSION && size >= headerSize(version);
+}
+
+bool readCompressed(const char* base, size_t size, uint64_t data_offset, const SaveTileEntry* index,
+                    uint64_t tile_count, uint64_t alive_tiles, bool swap,
+                    std::vector<Cell>& alive, std::vector<Cell>& god) {
+    uint64_t block_count;
+    if (data_offset > size || size - data_offset < sizeof(block_count)) return false;
+    std::memcpy(&block_count, base + data_offset, sizeof(block_count));
+    block_count = fix64(block_count, swap);
+    uint64_t table_offset = data_offset + sizeof(block_count);
+    if ((size - table_offset) / sizeof(SaveBlockEntry) < block_count) return false;
+    if (block_count != (tile_count + SAVE_BLOCK_TILES - 1) / SAVE_BLOCK_TILES) return false;
+
+    const SaveBlockEntry* blocks = reinterpret_cast<const SaveBlockEntry*>(base + table_offset);
+    const uint64_t block_bytes = SAVE_BLOCK_TILES * sizeof(Tile::rows);
+    auto decode = [&](uint64_t b, std::vector<Cell>& aliveOut, std::vector<Cell>& godOut) {
+        uint64_t offset = fix64(blocks[b].offset, swap);
+        uint64_t stored = fix64(blocks[b].size, swap);
+        uint64_t raw_size = fix64(blocks[b].raw_size, swap);
+        if (offset > size || size - offset < stored || raw_size > block_bytes) return false;
+        std::vector<uint64_t> raw(raw_size / sizeof(uint64_t) + 1); // Aligné pour les rangées
+        if (!lzDecompress(reinterpret_cast<const uint8_t*>(base + offset), stored,
+                          reinterpret_cast<uint8_t*>(raw.data()), raw_size)) {
+            return false;
+        }
+        uint64_t first = b * SAVE_BLOCK_TILES;
+        uint64_t last = std::min(first + SAVE_BLOCK_TILES, tile_count);
+        return decodeTiles(reinterpret_cast<const char*>(raw.data()), raw_size, b * block_bytes,
+                           index, first, last, alive_tiles, swap, aliveOut, godOut);
+    };
+    return decodeBlocks(block_count, decode, alive, god);
+}
+
+bool readTiled(const char* base, size_t size, std::vector<Cell>& alive,
+               std::vector<Cell>& god, RuleSet& rule, uint64_t* generation) {
+    const SaveHeader* header = reinterpret_cast<const SaveHeader*>(base);
+    bool swap;
+    uint32_t version;
+    if (!checkHeader(header, size, swap, version)) return false;
+
+    uint64_t alive_tiles = fix64(header->alive_tiles, swap);
+    uint64_t god_tiles = fix64(header->god_tiles, swap);
+    uint64_t index_offset = fix64(header->index_offset, swap);
+    uint64_t tile_count = alive_tiles + god_tiles;
+    if (index_offset > size || (size - index_offset) / sizeof(SaveTileEntry) < tile_count) return false;
+
+    const SaveTileEntry* index = reinterpret_cast<const SaveTileEntry*>(base + index_offset);
+    bool compressed = version >= 4 && (fix32(header->flags, swap) & SAVE_FLAG_COMPRESSED);
+    bool ok;
+    if (compressed) {
+        ok = readCompressed(base, size, fix64(header->data_offset, swap), index, tile_count,
+                            alive_tiles, swap, alive, god);
+    } else {
+        // Bitmaps lus directement dans le fichier mappé, par tranches de tuiles
+        auto decode = [&](uint64_t b, std::vector<Cell>& aliveOut, std::vector<Cell>& godOut) {
+            uint64_t first = b * SAVE_BLOCK_TILES;
+            uint64_t last = std::min(first + SAVE_BLOCK_TILES, tile_count);
+            return decodeTiles(base, size, 0, index, first, last, alive_tiles, swap, aliveOut, godOut);
+        };
+        ok = decodeBlocks((tile_count + SAVE_BLOCK_TILES - 1) / SAVE_BLOCK_TILES, decode, alive, god);
+    }
+    if (!ok) return false;
+
+    uint32_t stored_rule = fix32(header->rule, swap);
+    if (stored_rule < static_cast<uint32_t>(RuleSet::COUNT)) rule = static_cast<RuleSet>(stored_rule);
+    if (generation && version >= 3) *generation = fix64(header->generation, swap);
+    return true;
+}
+
+// Population et boîte englobante des tuiles, rangées dans l'en-tête
+void measureTiles(const std::vector<Tile>& tiles, SaveHeader& header) {
+    header.population = 0;
+    bool first = true;
+    for (const auto& tile : tiles) {
+        for (int r = 0; r < TILE_SIZE; ++r) {
+            uint64_t bits = tile.rows[r];
+            if (!bits) continue;
+            header.population += __builtin_popcountll(bits);
+            int64_t y = tile.ty * TILE_SIZE + r;
+            int64_t x0 = tile.tx * TILE_SIZE + __builtin_ctzll(bits);
+            int64_t x1 = tile.tx * TILE_SIZE + 63 - __builtin_clzll(bits);
+            if (first) {
+                header.min_x = x0;
+                header.max_x = x1;
+                header.min_y = header.max_y = y;
+                first = false;
+            }
+            header.min_x = std::min(header.min_x, x0);
+            header.max_x = std::max(header.max_x, x1);
+            header.min_y = std::min(header.min_y, y);
+            header.max_y = std::max(header.max_y, y);
+        }
+    }
+}
+
+// Aperçu : densité de cellules vivantes sur la boîte englobante
+void buildThumbnail(const std::vector<Tile>& alive, const SaveHeader& header, uint8_t* thumbnail) {
+    std::vector<uint32_t> counts(SAVE_THUMBNAIL_SIZE * SAVE_THUMBNAIL_SIZE, 0);
+    uint64_t width = Cell::key(header.max_x) - Cell::key(header.min_x);
+    uint64_t height = Cell::key(header.max_y) - Cell::key(header.min_y);
+    uint64_t scale = std::max(width, height) / SAVE_THUMBNAIL_SIZE + 1;
+    uint32_t max_count = 0;
+    for (const auto& tile : alive) {
+        for (int r = 0; r < TILE_SIZE; ++r) {
+            uint64_t py = (Cell::key(tile.ty * TILE_SIZE + r) - Cell::key(header.min_y)) / scale;
+            for (uint64_t bits = tile.rows[r]; bits; bits &= bits - 1) {
+                uint64_t px = (Cell::key(tile.tx * TILE_SIZE + __builtin_ctzll(bits)) - Cell::key(header.min_x)) / scale;
+                uint32_t& count = counts[py * SAVE_THUMBNAIL_SIZE + px];
+                max_count = std::max(max_count, ++count);
+            }
+        }
+    }
+    for (size_t i = 0; i < counts.size(); ++i) {
+        thumbnail[i] = counts[i] ? static_cast<uint8_t>(64 + 191 * static_cast<uint64_t>(counts[i]) / max_count) : 0;
+    }
+}
+
+}
+
+bool writeSaveFile(const std::string& filename, const std::vector<Tile>& aliveTiles,
+                   const std::vector<Tile>& godTiles, RuleSet rule, uint64_t generation,
+                   bool compress, std::atomic<float>* progress) {
+    TRACE_ZONE("writeSaveFile");
+    std::ofstream ofs(filename, std::ios::binary);
+    if (!ofs) return false;
+
+    SaveHeader header = {};
+    std::memcpy(header.magic, SAVE_MAGIC, sizeof(header.magic));
+    header.version = SAVE_VERSION;
+    header.endian_mark = SAVE_ENDIAN_MARK;
+    header.rule = static_cast<uint32_t>(rule);
+    header.flags = compress ? SAVE_FLAG_COMPRESSED : 0;
+    measureTiles(aliveTiles, header);
+    SaveHeader god = {};
+    measureTiles(godTiles, god);
+    header.god_count = god.population;
+    header.alive_tiles = aliveTiles.size();
+    header.god_tiles = godTiles.size();
+    header.generation = generation;
+    header.thumbnail_offset = sizeof(SaveHeader);
+    header.index_offset = header.thumbnail_offset + SAVE_THUMBNAIL_SIZE * SAVE_THUMBNAIL_SIZE;
+    header.data_offset = header.index_offset + (aliveTiles.size() + godTiles.size()) * sizeof(SaveTileEntry);
+    ofs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    std::vector<uint8_t> thumbnail(SAVE_THUMBNAIL_SIZE * SAVE_THUMBNAIL_SIZE);
+    buildThumbnail(aliveTiles, header, thumbnail.data());
+    ofs.write(reinterpret_cast<const char*>(thumbnail.data()), thumbnail.size());
+
+    // Index : position dans le fichier, ou dans les bitmaps décompressés
+    uint64_t offset = compress ? 0 : header.data_offset;
+    for (const auto* tiles : { &aliveTiles, &godTiles }) {
+        for (const auto& tile : *tiles) {
+            SaveTileEntry entry = { tile.tx, tile.ty, offset };
+            ofs.write(reinterpret_cast<const char*>(&entry), sizeof(entry));
+            offset += sizeof(tile.rows);
+        }
+    }
+    if (compress) {
+        writeCompressed(ofs, aliveTiles, godTiles, header.data_offset, progress);
+    } else {
+        size_t written = 0, total = aliveTiles.size() + godTiles.size();
+        writeTiles(ofs, aliveTiles, written, total, progress);
+        writeTiles(ofs, godTiles, written, total, progress);
+    }
+    if (progress) *progress = 1.0f;
+
+    ofs.close(); // Le dernier tampon peut encore échouer
+    return static_cast<bool>(ofs);
+}
+
+bool syncFile(const std::string& filename) {
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    bool synced = fsync(fd) == 0;
+    close(fd);
+    return synced;
+}
+
+bool readSaveFile(const std::string& filename, std::vector<Cell>& alive,
+                  std::vector<Cell>& god, RuleSet& rule, uint64_t* generation) {
+    TRACE_ZONE("readSaveFile");
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        close(fd);
+        return false;
+    }
+    size_t size = static_cast<size_t>(st.st_size);
+    void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED) return false;
+    madvise(mapped, size, MADV_SEQUENTIAL);
+
+    const char* base = static_cast<const char*>(mapped);
+    alive.clear();
+    god.clear();
+    bool ok;
+    if (size >= sizeof(SAVE_MAGIC) && std::memcmp(base, SAVE_MAGIC, sizeof(SAVE_MAGIC)) == 0) {
+        ok = readTiled(base, size, alive, god, rule, generation);
+    } else {
+        const char* data = base;
+        ok = readLegacyCells(data, base + size, alive) && readLegacyCells(data, base + size, god);
+    }
+
+    munmap(mapped, size);
+    return ok;
+}
+
+bool readSaveInfo(const std::string& filename, SaveInfo& info) {
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    info = SaveInfo();
+    SaveHeader header = {};
+    ssize_t got = pread(fd, &header, sizeof(header), 0);
+    bool swap;
+    uint32_t version;
+    if (got < 0 || !checkHeader(&header, static_cast<size_t>(got), swap, version)) {
+        // Ancien format : seul le nombre de cellules est connu
+        size_t count = 0;
+        bool legacy = got >= static_cast<ssize_t>(sizeof(count)) &&
+                      std::memcmp(&header, SAVE_MAGIC, sizeof(SAVE_MAGIC)) != 0;
+        if (legacy) std::memcpy(&count, &header, sizeof(count));
+        close(fd);
+        info.population = count;
+        return legacy;
+    }
+
+    info.version = version;
+    uint32_t rule = fix32(header.rule, swap);
+    info.rule = rule < static_cast<uint32_t>(RuleSet::COUNT) ? static_cast<RuleSet>(rule) : RuleSet::CONWAY;
+    info.population = fix64(header.population, swap);
+    info.min_x = static_cast<int64_t>(fix64(header.min_x, swap));
+    info.min_y = static_cast<int64_t>(fix64(header.min_y, swap));
+    info.max_x = static_cast<int64_t>(fix64(header.max_x, swap));
+    info.max_y = static_cast<int64_t>(fix64(header.max_y, swap));
+    if (version >= 3) {
+        info.generation = fix64(header.generation, swap);
+        off_t offset = static_cast<off_t>(fix64(header.thumbnail_offset, swap));
+        info.has_thumbnail = pread(fd, info.thumbnail, sizeof(info.thumbnail), offset) ==
+                             static_cast<ssize_t>(sizeof(info.thumbnail));
+    }
+    close(fd);
+    return true;
+}
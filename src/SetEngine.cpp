@@ -0,0 +1,110 @@
+#include "SetEngine.hpp"
+#include "Trace.hpp"
+
+#include <algorithm>
+#include <map>
+
+EngineKind SetEngine::kind() const {
+    return EngineKind::SET;
+}
+
+std::unique_ptr<GridEngine> SetEngine::clone() const {
+    return std::make_unique<SetEngine>(*this);
+}
+
+void SetEngine::setCell(int64_t x, int64_t y, bool alive) {
+    if (alive) cells.insert({x, y});
+    else cells.erase({x, y});
+}
+
+bool SetEngine::isAlive(int64_t x, int64_t y) const {
+    return cells.count({x, y}) != 0;
+}
+
+void SetEngine::clear() {
+    cells.clear();
+}
+
+void SetEngine::addCells(std::vector<Cell>& batch) {
+    cells.insert(batch.begin(), batch.end());
+}
+
+void SetEngine::load(std::vector<Cell> sorted) {
+    cells = std::set<Cell>(sorted.begin(), sorted.end());
+}
+
+void SetEngine::save(std::vector<Cell>& out) const {
+    out.assign(cells.begin(), cells.end());
+}
+
+bool SetEngine::step(RuleSet rule, const std::vector<Cell>& god, uint64_t& births) {
+    TRACE_ZONE("SetEngine::step");
+    std::map<Cell, int> neighbors;
+    for (const auto& cell : cells) {
+        for (int dx = -1; dx <= 1; dx++) {
+            for (int dy = -1; dy <= 1; dy++) {
+                if (dx != 0 || dy != 0) neighbors[{cell.x + dx, cell.y + dy}]++;
+            }
+        }
+    }
+
+    std::set<Cell> next;
+    for (const auto& entry : neighbors) {
+        bool alive = cells.count(entry.first) != 0;
+        int n = entry.second;
+        bool born = n == 3 || (rule == RuleSet::HIGHLIFE && n == 6);
+        if ((alive && (n == 2 || n == 3)) || (!alive && born)) next.insert(next.end(), entry.first);
+    }
+    // Une cellule Dieu garde son état
+    for (const auto& cell : god) {
+        if (cells.count(cell)) next.insert(cell);
+        else next.erase(cell);
+    }
+
+    births = 0;
+    for (const auto& cell : next) {
+        if (!cells.count(cell)) births++;
+    }
+    bool changed = next != cells;
+    cells.swap(next);
+    return changed;
+}
+
+void SetEngine::getCellsInRect(int64_t x0, int64_t y0, int64_t x1, int64_t y1, std::vector<Cell>& out) const {
+    for (const auto& cell : cells) {
+        if (cell.x >= x0 && cell.x <= x1 && cell.y >= y0 && cell.y <= y1) out.push_back(cell);
+    }
+}
+
+size_t SetEngine::population() const {
+    return cells.size();
+}
+
+bool SetEngine::bounds(int64_t& min_x, int64_t& min_y, int64_t& max_x, int64_t& max_y) const {
+    if (cells.empty()) return false;
+    min_x = max_x = cells.begin()->x;
+    min_y = max_y = cells.begin()->y;
+    for (const auto& cell : cells) {
+        min_x = std::min(min_x, cell.x);
+        max_x = std::max(max_x, cell.x);
+        min_y = std::min(min_y, cell.y);
+        max_y = std::max(max_y, cell.y);
+    }
+    return true;
+}
+
+// Cellules d'une même tuile contiguës dans l'ordre de Morton
+size_t SetEngine::tileCount() const {
+    size_t count = 0;
+    const Cell* previous = nullptr;
+    for (const auto& cell : cells) {
+        if (!previous || (cell.x >> 6) != (previous->x >> 6) || (cell.y >> 6) != (previous->y >> 6)) count++;
+        previous = &cell;
+    }
+    return count;
+}
+
+// Estimation : un noeud de l'arbre rouge-noir par cellule
+size_t SetEngine::memoryUsage() const {
+    return cells.size() * (sizeof(Cell) + 4 * sizeof(void*));
+}
@@ -0,0 +1,244 @@
+#include "SparseEngine.hpp"
+#include "Trace.hpp"
+
+#include <algorithm>
+#include <iterator>
+
+EngineKind SparseEngine::kind() const {
+    return EngineKind::SPARSE;
+}
+
+// Les tampons de travail ne sont pas copiés
+std::unique_ptr<GridEngine> SparseEngine::clone() const {
+    auto copy = std::make_unique<SparseEngine>();
+    copy->aliveCells = aliveCells;
+    return copy;
+}
+
+void SparseEngine::setCell(int64_t x, int64_t y, bool alive) {
+    Cell cell = {x, y};
+    auto it = std::lower_bound(aliveCells.begin(), aliveCells.end(), cell);
+    bool present = it != aliveCells.end() && *it == cell;
+    if (alive && !present) {
+        aliveCells.insert(it, cell);
+    } else if (!alive && present) {
+        aliveCells.erase(it);
+    }
+}
+
+bool SparseEngine::isAlive(int64_t x, int64_t y) const {
+    return std::binary_search(aliveCells.begin(), aliveCells.end(), Cell{x, y});
+}
+
+void SparseEngine::clear() {
+    aliveCells.clear();
+}
+
+void SparseEngine::addCells(std::vector<Cell>& cells) {
+    if (!std::is_sorted(cells.begin(), cells.end())) std::sort(cells.begin(), cells.end());
+    cells.erase(std::unique(cells.begin(), cells.end()), cells.end());
+    nextBuffer.clear();
+    std::set_union(aliveCells.begin(), aliveCells.end(), cells.begin(), cells.end(),
+                   std::back_inserter(nextBuffer));
+    std::swap(aliveCells, nextBuffer);
+}
+
+void SparseEngine::load(std::vector<Cell> cells) {
+    aliveCells = std::move(cells);
+}
+
+void SparseEngine::save(std::vector<Cell>& out) const {
+    out = aliveCells;
+}
+
+const std::vector<Cell>* SparseEngine::sortedCells() const {
+    return &aliveCells;
+}
+
+bool SparseEngine::step(RuleSet rule, const std::vector<Cell>& godCells, uint64_t& births) {
+    TRACE_ZONE("SparseEngine::step");
+    // Chaque cellule vivante "vote" pour ses 8 voisines : après le tri, la
+    // longueur de chaque série de doublons est le nombre de voisins.
+    {
+        TRACE_ZONE("neighbors");
+        neighborBuffer.clear();
+        for (const auto& cell : aliveCells) {
+            for (int dx = -1; dx <= 1; dx++) {
+                for (int dy = -1; dy <= 1; dy++) {
+                    if (dx == 0 && dy == 0) continue;
+                    neighborBuffer.push_back({cell.x + dx, cell.y + dy});
+                }
+            }
+        }
+    }
+    {
+        TRACE_ZONE("sort");
+        std::sort(neighborBuffer.begin(), neighborBuffer.end());
+    }
+
+    TRACE_ZONE("rules");
+    uint64_t born = 0;
+    nextBuffer.clear();
+    auto alive = aliveCells.begin();
+    size_t i = 0;
+    while (i < neighborBuffer.size()) {
+        const Cell cell = neighborBuffer[i];
+        size_t run = i + 1;
+        while (run < neighborBuffer.size() && neighborBuffer[run] == cell) run++;
+        int neighbors = run - i;
+        i = run;
+
+        // aliveCells et neighborBuffer sont triés : un seul parcours suffit
+        while (alive != aliveCells.end() && *alive < cell) alive++;
+        bool currentlyAlive = alive != aliveCells.end() && *alive == cell;
+        bool becomesAlive = false;
+
+        switch (rule) {
+            case RuleSet::CONWAY: 
+                if (!currentlyAlive && neighbors == 3) {
+                    becomesAlive = true; 
+                } else if (currentlyAlive && (neighbors == 2 || neighbors == 3)) {
+                    becomesAlive = true; 
+                }
+                break;
+            case RuleSet::HIGHLIFE: 
+                if (!currentlyAlive && (neighbors == 3 || neighbors == 6)) {
+                    becomesAlive = true; 
+                } else if (currentlyAlive && (neighbors == 2 || neighbors == 3)) {
+                    becomesAlive = true; 
+                }
+                break;
+            case RuleSet::COUNT:
+                break;
+        }
+        if (becomesAlive) {
+            nextBuffer.push_back(cell);
+            if (!currentlyAlive) born++;
+        }
+    }
+
+    // Masque des cellules Dieu : next = (next & ~god) | (cur & god).
+    // Appliqué une seule fois après les règles, il ne coûte rien sans cellules Dieu.
+    if (!godCells.empty()) {
+        TRACE_ZONE("god mask");
+        neighborBuffer.clear();
+        auto next = nextBuffer.begin();
+        auto god = godCells.begin();
+        alive = aliveCells.begin();
+        while (next != nextBuffer.end() || god != godCells.end()) {
+            if (god == godCells.end() || (next != nextBuffer.end() && *next < *god)) {
+                neighborBuffer.push_back(*next++);
+                continue;
+            }
+            bool wasBorn = next != nextBuffer.end() && *next == *god;
+            if (wasBorn) next++;
+            alive = std::lower_bound(alive, aliveCells.end(), *god);
+            if (alive != aliveCells.end() && *alive == *god) {
+                neighborBuffer.push_back(*god);
+            } else if (wasBorn) {
+                born--; // Cellule Dieu morte : elle le reste
+            }
+            god++;
+        }
+        std::swap(nextBuffer, neighborBuffer);
+    }
+
+    births = born;
+    // Sans naissance, la génération suivante ne contient que des cellules
+    // déjà vivantes : elle est identique si elle a la même taille
+    bool changed = born != 0 || nextBuffer.size() != aliveCells.size();
+
+    // Double tampon : l'ancienne génération devient le tampon de la suivante
+    std::swap(aliveCells, nextBuffer);
+    return changed;
+}
+
+void SparseEngine::getCellsInRect(int64_t x0, int64_t y0, int64_t x1, int64_t y1, std::vector<Cell>& out) const {
+    if (x0 > x1 || y0 > y1 || aliveCells.empty()) return;
+    uint64_t ux0 = Cell::key(x0), uy0 = Cell::key(y0);
+    uint64_t ux1 = Cell::key(x1), uy1 = Cell::key(y1);
+
+    // Plus petit carré aligné de Morton qui contient le rectangle
+    int level = 0;
+    while (level < 64 && ((ux0 >> level) != (ux1 >> level) || (uy0 >> level) != (uy1 >> level))) {
+        level++;
+    }
+    uint64_t qx = level < 64 ? ux0 >> level : 0;
+    uint64_t qy = level < 64 ? uy0 >> level : 0;
+    collectQuadrant(qx, qy, level, ux0, uy0, ux1, uy1, out);
+}
+
+void SparseEngine::collectQuadrant(uint64_t qx, uint64_t qy, int level,
+                                   uint64_t x0, uint64_t y0, uint64_t x1, uint64_t y1,
+                                   std::vector<Cell>& out) const {
+    // Le carré (qx, qy) de côté 2^level est un intervalle contigu de aliveCells
+    uint64_t span = level < 64 ? (1ULL << level) - 1 : ~0ULL;
+    uint64_t low_x = level < 64 ? qx << level : 0;
+    uint64_t low_y = level < 64 ? qy << level : 0;
+    uint64_t high_x = low_x + span, high_y = low_y + span;
+
+    auto toCell = [](uint64_t ux, uint64_t uy) {
+        return Cell{static_cast<int64_t>(ux ^ (1ULL << 63)), static_cast<int64_t>(uy ^ (1ULL << 63))};
+    };
+    auto begin = std::lower_bound(aliveCells.begin(), aliveCells.end(), toCell(low_x, low_y));
+    auto end = std::upper_bound(begin, aliveCells.end(), toCell(high_x, high_y));
+    if (begin == end) return;
+
+    if (low_x >= x0 && high_x <= x1 && low_y >= y0 && high_y <= y1) {
+        out.insert(out.end(), begin, end);
+        return;
+    }
+    if (level == 0 || end - begin <= 32) {
+        for (auto it = begin; it != end; ++it) {
+            uint64_t ux = Cell::key(it->x), uy = Cell::key(it->y);
+            if (ux >= x0 && ux <= x1 && uy >= y0 && uy <= y1) out.push_back(*it);
+        }
+        return;
+    }
+
+    // Sous-carrés dans l'ordre de Morton, en ignorant ceux hors du rectangle
+    uint64_t half = 1ULL << (level - 1);
+    for (int child = 0; child < 4; ++child) {
+        uint64_t cx = (qx << 1) | (child & 1);
+        uint64_t cy = (qy << 1) | (child >> 1);
+        uint64_t child_x = low_x + ((child & 1) ? half : 0);
+        uint64_t child_y = low_y + ((child >> 1) ? half : 0);
+        if (child_x > x1 || child_x + (half - 1) < x0) continue;
+        if (child_y > y1 || child_y + (half - 1) < y0) continue;
+        collectQuadrant(cx, cy, level - 1, x0, y0, x1, y1, out);
+    }
+}
+
+size_t SparseEngine::population() const {
+    return aliveCells.size();
+}
+
+bool SparseEngine::bounds(int64_t& min_x, int64_t& min_y, int64_t& max_x, int64_t& max_y) const {
+    if (aliveCells.empty()) return false;
+    min_x = max_x = aliveCells.front().x;
+    min_y = max_y = aliveCells.front().y;
+    for (const auto& cell : aliveCells) {
+        min_x = std::min(min_x, cell.x);
+        max_x = std::max(max_x, cell.x);
+        min_y = std::min(min_y, cell.y);
+        max_y = std::max(max_y, cell.y);
+    }
+    return true;
+}
+
+// Les tuiles étant des carrés alignés, leurs cellules sont contiguës dans
+// l'ordre de Morton : on compte les changements de tuile
+size_t SparseEngine::tileCount() const {
+    size_t count = 0;
+    for (size_t i = 0; i < aliveCells.size(); ++i) {
+        if (i == 0 || (aliveCells[i].x >> 6) != (aliveCells[i - 1].x >> 6) ||
+            (aliveCells[i].y >> 6) != (aliveCells[i - 1].y >> 6)) {
+            count++;
+        }
+    }
+    return count;
+}
+
+size_t SparseEngine::memoryUsage() const {
+    return (aliveCells.capacity() + neighborBuffer.capacity() + nextBuffer.capacity()) * sizeof(Cell);
+}
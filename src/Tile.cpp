@@ -0,0 +1,27 @@
+#include "Tile.hpp"
+
+#include <algorithm>
+
+void cellsToTiles(const std::vector<Cell>& cells, std::vector<Tile>& tiles) {
+    tiles.clear();
+    for (const auto& cell : cells) {
+        // Décalage arithmétique : arrondi vers -inf pour les coordonnées négatives
+        int64_t tx = cell.x >> 6, ty = cell.y >> 6;
+        if (tiles.empty() || tiles.back().tx != tx || tiles.back().ty != ty) {
+            tiles.push_back({tx, ty, {}});
+        }
+        tiles.back().rows[cell.y & 63] |= 1ULL << (cell.x & 63);
+    }
+}
+
+void appendTileCells(int64_t tx, int64_t ty, const uint64_t* rows, std::vector<Cell>& out) {
+    size_t first = out.size();
+    for (int r = 0; r < TILE_SIZE; ++r) {
+        uint64_t bits = rows[r];
+        while (bits) {
+            out.push_back({tx * TILE_SIZE + __builtin_ctzll(bits), ty * TILE_SIZE + r});
+            bits &= bits - 1;
+        }
+    }
+    std::sort(out.begin() + first, out.end());
+}
@@ -0,0 +1,105 @@
+#include "TileStore.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <fcntl.h>
+#include <iostream>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace {
+
+const size_t CHUNK_BYTES = STORE_CHUNK_TILES * sizeof(Tile);
+
+}
+
+std::shared_ptr<TileStore> TileStore::create(const std::string& directory) {
+    std::string path = (directory.empty() ? std::string(".") : directory) + "/shinra_tiles_XXXXXX";
+    int fd = mkstemp(&path[0]);
+    if (fd < 0) return nullptr;
+    unlink(path.c_str());
+    return std::shared_ptr<TileStore>(new TileStore(fd));
+}
+
+TileStore::TileStore(int fd) : fd(fd) {}
+
+// Les tuiles rangées tiennent le TileStore en vie : plus aucune n'existe ici
+TileStore::~TileStore() {
+    for (Tile* chunk : chunks) munmap(chunk, CHUNK_BYTES);
+    close(fd);
+}
+
+std::shared_ptr<Tile> TileStore::store(const Tile& tile) {
+    size_t slot;
+    Tile* target;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (freeSlots.empty()) {
+            // Nouveau bloc à la fin du fichier. La place est réservée sur le
+            // disque : un fichier creux ferait planter (SIGBUS) l'écriture
+            // dans la projection si le disque se remplissait.
+            off_t offset = static_cast<off_t>(chunks.size() * CHUNK_BYTES);
+            if (posix_fallocate(fd, offset, static_cast<off_t>(CHUNK_BYTES)) != 0) return nullptr;
+            void* memory = mmap(nullptr, CHUNK_BYTES, PROT_READ | PROT_WRITE, MAP_SHARED, fd, offset);
+            if (memory == MAP_FAILED) return nullptr;
+            size_t first = chunks.size() * STORE_CHUNK_TILES;
+            chunks.push_back(static_cast<Tile*>(memory));
+            for (size_t i = STORE_CHUNK_TILES; i > 0; --i) freeSlots.push_back(first + i - 1);
+        }
+        slot = freeSlots.back();
+        freeSlots.pop_back();
+        used++;
+        target = &chunks[slot / STORE_CHUNK_TILES][slot % STORE_CHUNK_TILES];
+    }
+    *target = tile;
+    std::shared_ptr<TileStore> self = shared_from_this();
+    return std::shared_ptr<Tile>(target, [self, slot](Tile*) { self->release(slot); });
+}
+
+void TileStore::release(size_t slot) {
+    std::lock_guard<std::mutex> lock(mutex);
+    freeSlots.push_back(slot);
+    used--;
+}
+
+// MAP_SHARED : les pages écrites restent dans le fichier (et le cache du
+// noyau), seule leur projection dans le processus est retirée. Une page
+// partagée avec une tuile voisine est retirée aussi : elle sera relue.
+// Les blocs sont alignés sur les pages, un intervalle n'en sort donc pas.
+void TileStore::dropResident(std::vector<const Tile*>& tiles) {
+    if (tiles.empty()) return;
+    std::sort(tiles.begin(), tiles.end());
+    uintptr_t page = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+    auto drop = [&](uintptr_t begin, uintptr_t end) {
+        if (madvise(reinterpret_cast<void*>(begin), end - begin, MADV_DONTNEED) != 0) {
+            std::cerr << "madvise failed on tile store" << std::endl;
+            return false;
+        }
+        return true;
+    };
+    // Pages des tuiles consécutives regroupées en intervalles
+    uintptr_t begin = 0, end = 0;
+    for (const Tile* tile : tiles) {
+        uintptr_t first = reinterpret_cast<uintptr_t>(tile) / page * page;
+        uintptr_t last = (reinterpret_cast<uintptr_t>(tile + 1) + page - 1) / page * page;
+        if (end && first <= end) {
+            end = std::max(end, last);
+            continue;
+        }
+        if (end && !drop(begin, end)) return;
+        begin = first;
+        end = last;
+    }
+    drop(begin, end);
+}
+
+size_t TileStore::storedTiles() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return used;
+}
+
+size_t TileStore::fileBytes() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return chunks.size() * CHUNK_BYTES;
+}
@@ -0,0 +1,515 @@
+#include "TiledEngine.hpp"
+#include "Trace.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <thread>
+
+namespace {
+
+// En dessous, le calcul d'une génération coûte moins cher que le lancement des threads
+const size_t PARALLEL_TILES = 256;
+// Tuiles calculées par lot : borne la mémoire de travail quand tout est à recalculer
+const size_t STEP_BATCH_TILES = 16384;
+
+template <typename Entry>
+bool tileBefore(const Entry& entry, const Cell& key) {
+    return Cell{entry.tile->tx, entry.tile->ty} < key;
+}
+
+bool tileEmpty(const Tile& tile) {
+    for (uint64_t row : tile.rows) {
+        if (row) return false;
+    }
+    return true;
+}
+
+size_t tileCells(const Tile& tile) {
+    size_t cells = 0;
+    for (uint64_t row : tile.rows) cells += __builtin_popcountll(row);
+    return cells;
+}
+
+}
+
+EngineKind TiledEngine::kind() const {
+    return EngineKind::TILED;
+}
+
+// Seuls les pointeurs sont copiés ; les tampons de travail, le budget et le
+// fichier d'échange restent ici
+std::unique_ptr<GridEngine> TiledEngine::clone() const {
+    auto copy = std::make_unique<TiledEngine>();
+    copy->tiles = tiles;
+    copy->count = count;
+    copy->generation = generation;
+    copy->pending = pending;
+    copy->lastRule = lastRule;
+    copy->lastGod = lastGod;
+    copy->storedCount = storedCount;
+    return copy;
+}
+
+TiledEngine::TileRef TiledEngine::newTile() {
+    if (spare.empty()) return std::make_shared<Tile>();
+    TileRef tile = std::move(spare.back());
+    spare.pop_back();
+    return tile;
+}
+
+Tile& TiledEngine::writable(TileEntry& entry) {
+    if (entry.stored || entry.tile.use_count() > 1) {
+        TileRef copy = newTile();
+        *copy = *entry.tile;
+        entry.tile = std::move(copy);
+        if (entry.stored) storedCount--;
+        entry.stored = false;
+    } else {
+        // use_count() est une lecture relâchée : la barrière ordonne les
+        // dernières lectures de la copie qui vient de lâcher la tuile (journal,
+        // sauvegarde, sur un autre thread) avant les écritures qui suivent
+        std::atomic_thread_fence(std::memory_order_acquire);
+    }
+    return *entry.tile;
+}
+
+// use_count() == 1 : aucune copie ne la tient, et aucune ne peut plus la
+// prendre puisque seul ce moteur la voit. Une tuile rangée libère sa place
+// dans le fichier.
+void TiledEngine::release(TileEntry& entry) {
+    if (entry.stored) {
+        storedCount--;
+    } else if (entry.tile.use_count() == 1 && spare.size() < tiles.size()) {
+        std::atomic_thread_fence(std::memory_order_acquire); // Voir writable()
+        spare.push_back(std::move(entry.tile));
+    }
+    entry.tile.reset();
+    entry.stored = false;
+}
+
+const Tile* TiledEngine::find(int64_t tx, int64_t ty) const {
+    auto it = std::lower_bound(tiles.begin(), tiles.end(), Cell{tx, ty}, tileBefore<TileEntry>);
+    return it != tiles.end() && it->tile->tx == tx && it->tile->ty == ty ? it->tile.get() : nullptr;
+}
+
+void TiledEngine::touch(int64_t tx, int64_t ty) {
+    for (int dy = -1; dy <= 1; ++dy) {
+        for (int dx = -1; dx <= 1; ++dx) pending.push_back({tx + dx, ty + dy});
+    }
+}
+
+void TiledEngine::touchAll() {
+    for (const auto& entry : tiles) touch(entry.tile->tx, entry.tile->ty);
+}
+
+void TiledEngine::setCell(int64_t x, int64_t y, bool alive) {
+    int64_t tx = x >> 6, ty = y >> 6;
+    uint64_t bit = 1ULL << (x & 63);
+    auto it = std::lower_bound(tiles.begin(), tiles.end(), Cell{tx, ty}, tileBefore<TileEntry>);
+    bool present = it != tiles.end() && it->tile->tx == tx && it->tile->ty == ty;
+    if (alive) {
+        if (!present) {
+            TileEntry entry;
+            entry.tile = newTile();
+            *entry.tile = Tile{tx, ty, {}};
+            it = tiles.insert(it, std::move(entry));
+        }
+        if (it->tile->rows[y & 63] & bit) return;
+        writable(*it).rows[y & 63] |= bit;
+        it->changed = generation;
+        count++;
+    } else if (present && (it->tile->rows[y & 63] & bit)) {
+        writable(*it).rows[y & 63] &= ~bit;
+        it->changed = generation;
+        count--;
+        if (tileEmpty(*it->tile)) {
+            release(*it);
+            tiles.erase(it);
+        }
+    } else {
+        return;
+    }
+    touch(tx, ty);
+}
+
+bool TiledEngine::isAlive(int64_t x, int64_t y) const {
+    const Tile* tile = find(x >> 6, y >> 6);
+    return tile && (tile->rows[y & 63] >> (x & 63) & 1);
+}
+
+void TiledEngine::clear() {
+    tiles.clear();
+    spare.clear();
+    pending.clear();
+    count = 0;
+    storedCount = 0;
+}
+
+// Les deux listes de tuiles sont triées : une fusion suffit
+void TiledEngine::addCells(std::vector<Cell>& cells) {
+    std::sort(cells.begin(), cells.end());
+    cellsToTiles(cells, nextTiles);
+    nextEntries.clear();
+    auto a = tiles.begin();
+    auto b = nextTiles.begin();
+    while (a != tiles.end() || b != nextTiles.end()) {
+        if (b == nextTiles.end() || (a != tiles.end() && tileBefore(*a, Cell{b->tx, b->ty}))) {
+            nextEntries.push_back(std::move(*a++));
+            continue;
+        }
+        if (a == tiles.end() || Cell{b->tx, b->ty} < Cell{a->tile->tx, a->tile->ty}) {
+            TileEntry entry;
+            entry.tile = newTile();
+            *entry.tile = *b;
+            count += tileCells(*b);
+            nextEntries.push_back(std::move(entry));
+        } else {
+            Tile& tile = writable(*a);
+            for (int r = 0; r < TILE_SIZE; ++r) {
+                count += __builtin_popcountll(b->rows[r] & ~tile.rows[r]);
+                tile.rows[r] |= b->rows[r];
+            }
+            nextEntries.push_back(std::move(*a++));
+        }
+        nextEntries.back().changed = generation;
+        touch(b->tx, b->ty);
+        b++;
+    }
+    tiles.swap(nextEntries);
+    nextEntries.clear();
+}
+
+void TiledEngine::load(std::vector<Cell> cells) {
+    clear();
+    cellsToTiles(cells, nextTiles);
+    for (const auto& tile : nextTiles) {
+        TileEntry entry;
+        entry.tile = newTile();
+        *entry.tile = tile;
+        entry.changed = generation;
+        tiles.push_back(std::move(entry));
+    }
+    count = cells.size();
+    touchAll();
+}
+
+void TiledEngine::loadTiles(std::vector<Tile> loaded) {
+    clear();
+    tiles.reserve(loaded.size());
+    for (const auto& tile : loaded) {
+        TileEntry entry;
+        entry.tile = std::make_shared<Tile>(tile);
+        entry.changed = generation;
+        count += tileCells(tile);
+        tiles.push_back(std::move(entry));
+    }
+    touchAll();
+}
+
+void TiledEngine::save(std::vector<Cell>& out) const {
+    out.clear();
+    out.reserve(count);
+    for (const auto& entry : tiles) appendTileCells(entry.tile->tx, entry.tile->ty, entry.tile->rows, out);
+}
+
+void TiledEngine::saveTiles(std::vector<Tile>& out) const {
+    out.clear();
+    out.reserve(tiles.size());
+    for (const auto& entry : tiles) out.push_back(*entry.tile);
+}
+
+void TiledEngine::computeTile(int64_t tx, int64_t ty, RuleSet rule, const std::vector<Cell>& god, Tile& out) const {
+    const Tile* around[3][3];
+    for (int dy = -1; dy <= 1; ++dy) {
+        for (int dx = -1; dx <= 1; ++dx) around[dy + 1][dx + 1] = find(tx + dx, ty + dy);
+    }
+
+    // Rangées -1 à 64 : la cellule elle-même (center) et ses voisines de
+    // gauche (west, bit k = cellule k - 1) et de droite (east, bit k = k + 1)
+    uint64_t west[TILE_SIZE + 2], center[TILE_SIZE + 2], east[TILE_SIZE + 2];
+    for (int i = 0; i < TILE_SIZE + 2; ++i) {
+        int r = i - 1, dy = 1;
+        if (r < 0) {
+            dy = 0;
+            r = TILE_SIZE - 1;
+        } else if (r >= TILE_SIZE) {
+            dy = 2;
+            r = 0;
+        }
+        uint64_t left = around[dy][0] ? around[dy][0]->rows[r] : 0;
+        uint64_t middle = around[dy][1] ? around[dy][1]->rows[r] : 0;
+        uint64_t right = around[dy][2] ? around[dy][2]->rows[r] : 0;
+        center[i] = middle;
+        west[i] = (middle << 1) | (left >> 63);
+        east[i] = (middle >> 1) | (right << 63);
+    }
+
+    out.tx = tx;
+    out.ty = ty;
+    for (int r = 0; r < TILE_SIZE; ++r) {
+        // Compteur de voisins sur 4 bits par cellule (s0 : poids faible)
+        uint64_t s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+        auto add = [&](uint64_t word) {
+            uint64_t c0 = s0 & word;
+            s0 ^= word;
+            uint64_t c1 = s1 & c0;
+            s1 ^= c0;
+            uint64_t c2 = s2 & c1;
+            s2 ^= c1;
+            s3 |= c2;
+        };
+        add(west[r]);
+        add(center[r]);
+        add(east[r]);
+        add(west[r + 1]);
+        add(east[r + 1]);
+        add(west[r + 2]);
+        add(center[r + 2]);
+        add(east[r + 2]);
+
+        uint64_t alive = center[r + 1];
+        uint64_t two = ~s0 & s1 & ~s2 & ~s3;
+        uint64_t three = s0 & s1 & ~s2 & ~s3;
+        uint64_t next = three | (alive & two);
+        if (rule == RuleSet::HIGHLIFE) next |= ~alive & ~s0 & s1 & s2 & ~s3; // Naissance à 6
+        out.rows[r] = next;
+    }
+
+    // Cellules Dieu de la tuile (contiguës dans l'ordre de Morton) : elles gardent leur état
+    auto first = std::lower_bound(god.begin(), god.end(), Cell{tx * TILE_SIZE, ty * TILE_SIZE});
+    auto last = std::upper_bound(first, god.end(), Cell{tx * TILE_SIZE + TILE_SIZE - 1, ty * TILE_SIZE + TILE_SIZE - 1});
+    for (auto it = first; it != last; ++it) {
+        int r = static_cast<int>(it->y & 63);
+        uint64_t bit = 1ULL << (it->x & 63);
+        out.rows[r] = (out.rows[r] & ~bit) | (center[r + 1] & bit);
+    }
+}
+
+bool TiledEngine::step(RuleSet rule, const std::vector<Cell>& god, uint64_t& births) {
+    TRACE_ZONE("TiledEngine::step");
+    if (rule != lastRule || god != lastGod) {
+        touchAll();
+        lastRule = rule;
+        lastGod = god;
+    }
+    generation++;
+
+    // Tuiles dont le voisinage a changé ; les autres gardent leur état
+    candidates.swap(pending);
+    pending.clear();
+    std::sort(candidates.begin(), candidates.end());
+    candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
+    // Les anciennes tuiles servent de voisines jusqu'au dernier lot : les
+    // lots ne font que noter les tuiles qui changent (updates), fusionnées
+    // ensuite dans tiles
+    births = 0;
+    bool changed = false;
+    updates.clear();
+    auto current = tiles.cbegin();
+    for (size_t batch = 0; batch < candidates.size(); batch += STEP_BATCH_TILES) {
+        size_t batch_size = std::min(STEP_BATCH_TILES, candidates.size() - batch);
+        const Cell* coords = candidates.data() + batch;
+        nextTiles.resize(batch_size);
+        auto work = [&](size_t begin, size_t end) {
+            TRACE_ZONE("tiles");
+            for (size_t i = begin; i < end; ++i) computeTile(coords[i].x, coords[i].y, rule, god, nextTiles[i]);
+        };
+        size_t thread_count = 1;
+        if (batch_size >= PARALLEL_TILES) {
+            thread_count = std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()),
+                                            batch_size / (PARALLEL_TILES / 4));
+        }
+        std::vector<std::thread> workers;
+        for (size_t t = 1; t < thread_count; ++t) {
+            workers.emplace_back(work, batch_size * t / thread_count, batch_size * (t + 1) / thread_count);
+        }
+        work(0, batch_size / thread_count);
+        for (auto& worker : workers) worker.join();
+
+        // Naissances et changements. Une tuile inchangée reste la même
+        // (toujours partagée avec les copies, ou dans le fichier d'échange).
+        for (const auto& tile : nextTiles) {
+            Cell coord = {tile.tx, tile.ty};
+            current = std::lower_bound(current, tiles.cend(), coord, tileBefore<TileEntry>);
+            bool found = current != tiles.cend() && current->tile->tx == tile.tx && current->tile->ty == tile.ty;
+            const Tile* before = found ? current->tile.get() : nullptr;
+            uint64_t columns = 0; // Colonnes qui ont changé
+            for (int r = 0; r < TILE_SIZE; ++r) {
+                uint64_t old = before ? before->rows[r] : 0;
+                births += __builtin_popcountll(tile.rows[r] & ~old);
+                count += __builtin_popcountll(tile.rows[r]);
+                count -= __builtin_popcountll(old);
+                columns |= tile.rows[r] ^ old;
+            }
+            if (!columns) continue;
+            changed = true;
+
+            // À recalculer ensuite : la tuile, et ses voisines du côté des
+            // bords et des coins qui ont changé
+            uint64_t top = tile.rows[0] ^ (before ? before->rows[0] : 0);
+            uint64_t bottom = tile.rows[TILE_SIZE - 1] ^ (before ? before->rows[TILE_SIZE - 1] : 0);
+            pending.push_back(coord);
+            if (top) pending.push_back({tile.tx, tile.ty - 1});
+            if (bottom) pending.push_back({tile.tx, tile.ty + 1});
+            if (columns & 1) pending.push_back({tile.tx - 1, tile.ty});
+            if (columns >> 63) pending.push_back({tile.tx + 1, tile.ty});
+            if (top & 1) pending.push_back({tile.tx - 1, tile.ty - 1});
+            if (top >> 63) pending.push_back({tile.tx + 1, tile.ty - 1});
+            if (bottom & 1) pending.push_back({tile.tx - 1, tile.ty + 1});
+            if (bottom >> 63) pending.push_back({tile.tx + 1, tile.ty + 1});
+
+            TileUpdate update = {coord, nullptr};
+            if (!tileEmpty(tile)) {
+                update.tile = newTile();
+                *update.tile = tile;
+            }
+            updates.push_back(std::move(update));
+        }
+    }
+
+    // Fusion des deux listes triées ; les tuiles remplacées sont rendues
+    nextEntries.clear();
+    auto next = tiles.begin();
+    for (auto& update : updates) {
+        while (next != tiles.end() && tileBefore(*next, update.coord)) nextEntries.push_back(std::move(*next++));
+        if (next != tiles.end() && next->tile->tx == update.coord.x && next->tile->ty == update.coord.y) {
+            release(*next++);
+        }
+        if (!update.tile) continue;
+        TileEntry entry;
+        entry.tile = std::move(update.tile);
+        entry.changed = generation;
+        nextEntries.push_back(std::move(entry));
+    }
+    while (next != tiles.end()) nextEntries.push_back(std::move(*next++));
+    tiles.swap(nextEntries);
+    nextEntries.clear();
+    updates.clear();
+    if (budget) evict();
+    return changed;
+}
+
+void TiledEngine::getCellsInRect(int64_t x0, int64_t y0, int64_t x1, int64_t y1, std::vector<Cell>& out) const {
+    if (x0 > x1 || y0 > y1) return;
+    int64_t tx0 = x0 >> 6, ty0 = y0 >> 6, tx1 = x1 >> 6, ty1 = y1 >> 6;
+    uint64_t rows[TILE_SIZE];
+    for (const auto& entry : tiles) {
+        const Tile& tile = *entry.tile;
+        if (tile.tx < tx0 || tile.tx > tx1 || tile.ty < ty0 || tile.ty > ty1) continue;
+        // Masque des colonnes et des lignes du rectangle dans cette tuile
+        int64_t base_x = tile.tx * TILE_SIZE, base_y = tile.ty * TILE_SIZE;
+        int c0 = static_cast<int>(std::max<int64_t>(x0 - base_x, 0));
+        int c1 = static_cast<int>(std::min<int64_t>(x1 - base_x, TILE_SIZE - 1));
+        int r0 = static_cast<int>(std::max<int64_t>(y0 - base_y, 0));
+        int r1 = static_cast<int>(std::min<int64_t>(y1 - base_y, TILE_SIZE - 1));
+        uint64_t columns = (c1 == 63 ? ~0ULL : (1ULL << (c1 + 1)) - 1) & ~((1ULL << c0) - 1);
+        for (int r = 0; r < TILE_SIZE; ++r) rows[r] = r >= r0 && r <= r1 ? tile.rows[r] & columns : 0;
+        appendTileCells(tile.tx, tile.ty, rows, out);
+    }
+}
+
+size_t TiledEngine::population() const {
+    return count;
+}
+
+// Colonnes extrêmes d'après le OU des rangées, lignes extrêmes d'après la
+// première et la dernière rangée non vide
+bool TiledEngine::bounds(int64_t& min_x, int64_t& min_y, int64_t& max_x, int64_t& max_y) const {
+    if (tiles.empty()) return false;
+    min_x = min_y = INT64_MAX;
+    max_x = max_y = INT64_MIN;
+    for (const auto& entry : tiles) {
+        const Tile& tile = *entry.tile;
+        uint64_t columns = 0;
+        int first = -1, last = -1;
+        for (int r = 0; r < TILE_SIZE; ++r) {
+            if (!tile.rows[r]) continue;
+            columns |= tile.rows[r];
+            if (first < 0) first = r;
+            last = r;
+        }
+        if (!columns) continue;
+        int64_t base_x = tile.tx * TILE_SIZE, base_y = tile.ty * TILE_SIZE;
+        min_x = std::min(min_x, base_x + __builtin_ctzll(columns));
+        max_x = std::max(max_x, base_x + 63 - __builtin_clzll(columns));
+        min_y = std::min(min_y, base_y + first);
+        max_y = std::max(max_y, base_y + last);
+    }
+    return true;
+}
+
+size_t TiledEngine::tileCount() const {
+    return tiles.size();
+}
+
+// Les tuiles rangées dans le fichier d'échange ne comptent pas
+size_t TiledEngine::memoryUsage() const {
+    size_t shared = 0;
+    for (const auto& entry : tiles) {
+        if (!entry.stored) shared += sizeof(Tile) / std::max<long>(1, entry.tile.use_count());
+    }
+    return shared + (spare.size() + nextTiles.capacity()) * sizeof(Tile) +
+           (tiles.capacity() + nextEntries.capacity()) * sizeof(TileEntry) + spare.capacity() * sizeof(TileRef) +
+           updates.capacity() * sizeof(TileUpdate) +
+           (candidates.capacity() + pending.capacity() + lastGod.capacity()) * sizeof(Cell);
+}
+
+void TiledEngine::setBudget(size_t bytes, std::shared_ptr<TileStore> tileStore) {
+    budget = bytes;
+    store = std::move(tileStore);
+    evictScan = 0;
+    if (budget) evict();
+}
+
+size_t TiledEngine::evictedTiles() const {
+    return storedCount;
+}
+
+// La réserve (spare) est gardée dans la marge des 10 % sous le budget. Quand
+// les tuiles endormies ne suffisent pas, la recherche ne reprend qu'à la
+// génération où la plus jeune des autres pourra partir.
+void TiledEngine::evict() {
+    if (!store) return;
+    size_t limit = budget / sizeof(Tile);
+    if (spare.size() > limit / 10) spare.resize(limit / 10);
+    size_t resident = tiles.size() - storedCount;
+    if (resident <= limit || generation < evictScan) return;
+    TRACE_ZONE("TiledEngine::evict");
+
+    // Tuiles endormies que personne d'autre ne tient, les plus anciennes
+    // d'abord, jusqu'à 90 % du budget pour ne pas recommencer à chaque génération
+    std::vector<size_t> victims;
+    uint64_t retry = generation + TILE_EVICT_GENERATIONS;
+    for (size_t i = 0; i < tiles.size(); ++i) {
+        const TileEntry& entry = tiles[i];
+        if (entry.stored || entry.tile.use_count() != 1) continue;
+        if (generation - entry.changed >= TILE_EVICT_GENERATIONS) victims.push_back(i);
+        else retry = std::min(retry, entry.changed + TILE_EVICT_GENERATIONS);
+    }
+    size_t wanted = resident - (limit - limit / 10);
+    if (victims.size() > wanted) {
+        std::nth_element(victims.begin(), victims.begin() + wanted, victims.end(),
+                         [&](size_t a, size_t b) { return tiles[a].changed < tiles[b].changed; });
+        victims.resize(wanted);
+    }
+    evictScan = victims.size() < wanted ? retry : 0;
+    if (victims.empty()) return;
+
+    std::vector<const Tile*> written;
+    written.reserve(victims.size());
+    for (size_t i : victims) {
+        TileRef stored = store->store(*tiles[i].tile);
+        if (!stored) {
+            std::cerr << "Tile swap file is full, eviction stopped" << std::endl;
+            break;
+        }
+        written.push_back(stored.get());
+        tiles[i].tile = std::move(stored);
+        tiles[i].stored = true;
+        storedCount++;
+    }
+    store->dropResident(written);
+    if (written.size() < victims.size()) store.reset();
+}
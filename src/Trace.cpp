@@ -0,0 +1,145 @@
+#include "Trace.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+std::atomic<bool> traceEnabled{true};
+
+namespace {
+
+// Champs atomiques (accès relâchés) : l'export peut lire une case pendant que
+// son thread la réécrit, les cases écrasées entre-temps sont écartées
+struct TraceSlot {
+    std::atomic<const char*> name{nullptr};
+    std::atomic<uint64_t> start{0};
+    std::atomic<uint64_t> end{0};
+};
+
+struct TraceBuffer {
+    std::atomic<uint64_t> head{0}; // Nombre total d'événements écrits
+    std::atomic<bool> in_use{true};
+    std::atomic<uint32_t> tid{0};
+    TraceSlot slots[TRACE_BUFFER_EVENTS];
+};
+
+std::mutex registryMutex;
+std::vector<std::unique_ptr<TraceBuffer>> registry;
+uint32_t nextTid = 1;
+
+// Un tampon par thread vivant. Celui d'un thread terminé est repris par le
+// suivant (les threads de travail sont créés à chaque appel) : ses anciens
+// événements restent, sous le numéro du nouveau thread.
+struct ThreadBuffer {
+    TraceBuffer* buffer;
+
+    ThreadBuffer() {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        buffer = nullptr;
+        for (auto& candidate : registry) {
+            if (!candidate->in_use.load(std::memory_order_acquire)) {
+                buffer = candidate.get();
+                break;
+            }
+        }
+        if (!buffer) {
+            registry.push_back(std::make_unique<TraceBuffer>());
+            buffer = registry.back().get();
+        }
+        buffer->in_use.store(true, std::memory_order_relaxed);
+        buffer->tid.store(nextTid++, std::memory_order_relaxed);
+    }
+
+    ~ThreadBuffer() {
+        buffer->in_use.store(false, std::memory_order_release);
+    }
+};
+
+struct TraceEvent {
+    const char* name;
+    uint64_t start, end;
+    uint32_t tid;
+    uint64_t index; // Numéro de l'événement dans le tampon de son thread
+};
+
+}
+
+uint64_t traceNow() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+void traceRecord(const char* name, uint64_t start_ns, uint64_t end_ns) {
+    thread_local ThreadBuffer local;
+    TraceBuffer* buffer = local.buffer;
+    uint64_t head = buffer->head.load(std::memory_order_relaxed);
+    TraceSlot& slot = buffer->slots[head % TRACE_BUFFER_EVENTS];
+    // Le nom est écrit en dernier : une case incomplète a un nom nul
+    slot.name.store(nullptr, std::memory_order_relaxed);
+    slot.start.store(start_ns, std::memory_order_relaxed);
+    slot.end.store(end_ns, std::memory_order_relaxed);
+    slot.name.store(name, std::memory_order_release);
+    buffer->head.store(head + 1, std::memory_order_release);
+}
+
+bool writeChromeTrace(const std::string& path, double seconds) {
+    std::vector<TraceEvent> events;
+    {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        for (auto& buffer : registry) {
+            uint64_t head = buffer->head.load(std::memory_order_acquire);
+            uint64_t first = head > TRACE_BUFFER_EVENTS ? head - TRACE_BUFFER_EVENTS : 0;
+            size_t copied_from = events.size();
+            uint32_t tid = buffer->tid.load(std::memory_order_relaxed);
+            for (uint64_t i = first; i < head; ++i) {
+                TraceSlot& slot = buffer->slots[i % TRACE_BUFFER_EVENTS];
+                const char* name = slot.name.load(std::memory_order_acquire);
+                if (name) events.push_back({name, slot.start.load(std::memory_order_relaxed),
+                                            slot.end.load(std::memory_order_relaxed), tid, i});
+            }
+            // Cases réécrites pendant la copie, y compris celle que le thread
+            // est peut-être en train d'écrire (numéro after) : on les écarte
+            uint64_t after = buffer->head.load(std::memory_order_acquire);
+            uint64_t valid = after + 1 > TRACE_BUFFER_EVENTS ? after + 1 - TRACE_BUFFER_EVENTS : 0;
+            events.erase(std::remove_if(events.begin() + copied_from, events.end(), [valid](const TraceEvent& event) {
+                return event.index < valid;
+            }), events.end());
+        }
+    }
+
+    uint64_t now = traceNow();
+    if (seconds > 0) {
+        uint64_t window = static_cast<uint64_t>(seconds * 1e9);
+        events.erase(std::remove_if(events.begin(), events.end(), [&](const TraceEvent& event) {
+            return event.end + window < now;
+        }), events.end());
+    }
+    std::sort(events.begin(), events.end(), [](const TraceEvent& a, const TraceEvent& b) {
+        return a.start < b.start;
+    });
+    uint64_t origin = events.empty() ? now : events.front().start;
+
+    std::string tmp = path + ".tmp";
+    std::ofstream ofs(tmp, std::ios::trunc);
+    ofs << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    char line[256];
+    for (size_t i = 0; i < events.size(); ++i) {
+        const TraceEvent& event = events[i];
+        std::snprintf(line, sizeof(line),
+                      "%s\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                      i ? "," : "", event.name, event.tid, (event.start - origin) / 1000.0,
+                      (event.end - event.start) / 1000.0);
+        ofs << line;
+    }
+    ofs << "\n]}\n";
+    ofs.close();
+    if (!ofs || std::rename(tmp.c_str(), path.c_str()) != 0) {
+        std::remove(tmp.c_str());
+        return false;
+    }
+    return true;
+}
@@ -1,7 +1,48 @@
 #include "Game.hpp"
+#include "Headless.hpp"
+
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+int main(int argc, char** argv) {
+    if (isHeadless(argc, argv)) {
+        return runHeadless(argc, argv);
+    }
+    // Fenêtre : --metrics FILE [--metrics-interval S], --record-input FILE,
+    // --replay-input FILE (sans fenêtre, pilote vidéo "dummy")
+    std::string metricsFile, recordInput, replayInput;
+    double metricsInterval = 10.0;
+    for (int i = 1; i + 1 < argc; ++i) {
+        if (std::strcmp(argv[i], "--metrics") == 0) {
+            metricsFile = argv[++i];
+        } else if (std::strcmp(argv[i], "--metrics-interval") == 0) {
+            try {
+                metricsInterval = std::stod(argv[++i]);
+            } catch (const std::logic_error&) {
+                std::cerr << "Invalid value for --metrics-interval: " << argv[i] << std::endl;
+                printUsage(std::cerr);
+                return 1;
+            }
+        } else if (std::strcmp(argv[i], "--record-input") == 0) {
+            recordInput = argv[++i];
+        } else if (std::strcmp(argv[i], "--replay-input") == 0) {
+            replayInput = argv[++i];
+        }
+    }
+    if (!replayInput.empty()) SDL_SetHint(SDL_HINT_VIDEODRIVER, "dummy");
 
-int main() {
     Game game;
+    if (!metricsFile.empty()) game.enableMetrics(metricsFile, metricsInterval);
+    if (!recordInput.empty() && !game.recordInput(recordInput)) {
+        std::cerr << "Failed to open input log " << recordInput << std::endl;
+        return 1;
+    }
+    if (!replayInput.empty() && !game.replayInput(replayInput)) {
+        std::cerr << "Failed to read input log " << replayInput << std::endl;
+        return 1;
+    }
     game.run();
     return 0;
-}
\ No newline at end of file
+}